@@ -1,13 +1,9 @@
 #pragma once
 
-#include <vector>
-#include <utility>
+#include "zd_heurist_base.h"
 
-class ZD_heurist_QAP1 {
+class ZD_heurist_QAP1 : public ZD_heurist_base {
 public:
-    // cost_t[i][j][k][l] is cost between i and j if pos[i] = k, pos[j] = l
-    using cost_t = std::vector<std::vector<std::vector<std::vector<long long>>>>;
-
     /// @brief Z. Drezner, A New Heuristic for the Quadratic Assignment Problem implementation.
     /// @brief Journal of Applied Mathematics and Decision Sciences, 6(3), 2002, 143-153.
     /// @param cost is symmetric zero-diagonal matrix.
@@ -16,101 +12,6 @@ public:
 
     ZD_heurist_QAP1(const cost_t& cost, int maxListSize);
 
-    /// @brief solves QAP problem using Z. Drezner heuristic
-    /// @return permutation \param p where i-th facility assigned to p[i]-th position.
-    std::vector<int> solve(int time = -1, int seed = -1, int debug_t = -1, double start_t = 0);
-
-    std::vector<std::pair<double, std::vector<int>>> get_debug_info() const;
-
-    ~ZD_heurist_QAP1();
-
-private:
-
-    long long* C;
-    int K;
-    int d{};
-
-    int n;
-    int n2, n3, n4;
-
-    [[nodiscard]] inline int idx(int i, int j, int k, int l) const;
-
-    struct Solution {
-        int* p;
-        long long obv;
-        int size;
-
-        Solution();
-        Solution(int* perm, long long obvPerm, int n);
-        Solution(const Solution& other);
-        Solution(Solution&& other) noexcept;
-        Solution& operator=(const Solution& other);
-        Solution& operator=(Solution&& other) noexcept;
-        ~Solution();
-
-        void print() const;
-    };
-
-    struct SolutionFactory {
-
-        explicit SolutionFactory(int size);
-
-        SolutionFactory() = delete;
-        SolutionFactory(const SolutionFactory&) = delete;
-        SolutionFactory(SolutionFactory&&) = delete;
-        SolutionFactory& operator=(const SolutionFactory&) = delete;
-        SolutionFactory& operator=(SolutionFactory&&) = delete;
-        ~SolutionFactory();
-
-        Solution* create(const int* p, long long obv);
-
-        void free();
-        void freeLast();
-        void clear();
-
-        int n;
-
-        std::vector<Solution*> own;
-        std::vector<Solution*> freed;
-    } solutionFactory;
-
-    struct List {
-        Solution** a;
-        int size;
-        Solution** worst;
-        int K;
-
-        void add(Solution* s);
-        void clear();
-
-        List();
-        explicit List(int k);
-        List(const List& other);
-        List(List&& other) noexcept;
-        List& operator=(const List& other);
-        List& operator=(List&& other) noexcept;
-        ~List();
-    };
-
-    [[nodiscard]] long long obv(const int* w) const;
-    [[nodiscard]] int* randPerm(int seed = -1) const;
-
-    [[nodiscard]] long long deltaObv(int r, int s, const int* w) const;
-    [[nodiscard]] int deltaP(const int* p, const int* w) const;
-    [[nodiscard]] int deltaDeltaP(const int* w, const int* bfs, int j, int k) const;
-
-    void newBfs(List& list0, Solution& bfs, Solution& bfs2);
-    void updLists(List& list0, List& list1, List& list2, int dp, const Solution& bfs);
-    bool inlist(List& x, Solution* s);
-    void QAP_iter(Solution& center, Solution& bfs, Solution& bfs2, List& memory);
-
-    [[nodiscard]] Solution bestMemory(const List& memory) const;
-
-    //debug
-    int debug_interval{-1};
-    std::vector<std::pair<double, std::vector<int>>> debug_info{};
-
-    //time
-    clock_t max_time;
-    clock_t start;
-};
\ No newline at end of file
+    /// @brief takes a CostTensor without copying it, or a GridCostOracle for large n.
+    ZD_heurist_QAP1(QapCost cost, int maxListSize);
+};
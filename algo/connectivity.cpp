@@ -0,0 +1,86 @@
+#include "connectivity.h"
+
+#include <algorithm>
+
+int ConnectivityModel::find(int a, int b) const {
+    auto first = neighbor.begin() + start[a];
+    auto last = neighbor.begin() + start[a + 1];
+    auto it = std::lower_bound(first, last, b);
+    if (it == last || *it != b) {
+        return -1;
+    }
+    return (int) (it - neighbor.begin());
+}
+
+ConnectivityModel ConnectivityModel::from_records(int devices, std::vector<Record> records) {
+    std::sort(records.begin(), records.end(), [](const Record& x, const Record& y) {
+        return x.a != y.a ? x.a < y.a : x.b < y.b;
+    });
+
+    // merge duplicates in place
+    int unique = 0;
+    for (const Record& r : records) {
+        if (unique > 0 && records[unique - 1].a == r.a && records[unique - 1].b == r.b) {
+            PairTerms& t = records[unique - 1].terms;
+            t.mul_x += r.terms.mul_x;
+            t.left += r.terms.left;
+            t.same_x += r.terms.same_x;
+            t.mul_y += r.terms.mul_y;
+            t.up += r.terms.up;
+            t.same_y += r.terms.same_y;
+        } else {
+            records[unique++] = r;
+        }
+    }
+    records.resize(unique);
+
+    ConnectivityModel model;
+    model.devices = devices;
+    model.start.assign(devices + 1, 0);
+    for (const Record& r : records) {
+        ++model.start[r.a + 1];
+        ++model.start[r.b + 1];
+    }
+    for (int a = 0; a < devices; ++a) {
+        model.start[a + 1] += model.start[a];
+    }
+    model.neighbor.resize(model.start[devices]);
+    model.terms.resize(model.start[devices]);
+
+    // records are sorted by (a, b): the b-side entries (b, a) arrive with increasing a,
+    // the a-side entries (a, b) with increasing b, and every a-side b is above every b-side a
+    std::vector<int> pos(model.start.begin(), model.start.end() - 1);
+    for (const Record& r : records) {
+        int e = pos[r.b]++;
+        model.neighbor[e] = r.a;
+        model.terms[e] = {r.terms.mul_x, -r.terms.left, r.terms.same_x, r.terms.mul_y, -r.terms.up, r.terms.same_y};
+    }
+    for (const Record& r : records) {
+        int e = pos[r.a]++;
+        model.neighbor[e] = r.b;
+        model.terms[e] = r.terms;
+    }
+    return model;
+}
+
+ConnectivityModel ConnectivityModel::from_dense(const matrix_t& left, const matrix_t& same_x,
+                                                const matrix_t& up, const matrix_t& same_y,
+                                                const matrix_t& mul) {
+    auto zero = [&](int a, int b) {
+        return mul[a][b] == 0 && left[a][b] == 0 && same_x[a][b] == 0 && up[a][b] == 0 && same_y[a][b] == 0;
+    };
+
+    ConnectivityModel model;
+    model.devices = (int) mul.size();
+    model.start.assign(model.devices + 1, 0);
+    for (int a = 0; a < model.devices; ++a) {
+        for (int b = 0; b < model.devices; ++b) {
+            if (a != b && (!zero(a, b) || !zero(b, a))) {
+                model.neighbor.push_back(b);
+                model.terms.push_back({mul[a][b], left[a][b], same_x[a][b], mul[a][b], up[a][b], same_y[a][b]});
+            }
+        }
+        model.start[a + 1] = (int) model.neighbor.size();
+    }
+    return model;
+}
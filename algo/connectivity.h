@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+// Terms of one ordered device pair (a, b), summed over the weighted pin pairs (pin of a, pin of b)
+// the net model makes of every net. Pin coordinates are relative to the device centers.
+// Pairs carry separate x and y weights, the bound-to-bound model connects different pins along each axis.
+struct PairTerms {
+    long long mul_x;  // sum of x weights, multiplies the center distance along x
+    long long left;   // x_b - x_a
+    long long same_x; // |x_a - x_b|
+    long long mul_y;  // sum of y weights
+    long long up;     // y_a - y_b
+    long long same_y; // |y_a - y_b|
+};
+
+// Sparse device adjacency: row a of the CSR lists, in increasing order, the devices sharing a net with a,
+// terms[e] belongs to the edge (a, neighbor[e]). Both directions are stored, the terms of (b, a)
+// are those of (a, b) with left and up negated. Memory is O(devices + edges).
+struct ConnectivityModel {
+    using matrix_t = std::vector<std::vector<long long>>;
+
+    int devices{0};
+    std::vector<int> start;     // devices + 1
+    std::vector<int> neighbor;  // edges
+    std::vector<PairTerms> terms; // edges
+
+    [[nodiscard]] int degree(int a) const { return start[a + 1] - start[a]; }
+    [[nodiscard]] int edges() const { return (int) neighbor.size(); }
+
+    // edge index of (a, b) or -1, O(log degree)
+    [[nodiscard]] int find(int a, int b) const;
+
+    // from accumulated (a, b, terms) records with a < b, duplicates are summed
+    struct Record {
+        int a;
+        int b;
+        PairTerms terms;
+    };
+    static ConnectivityModel from_records(int devices, std::vector<Record> records);
+
+    // from dense matrices indexed [a][b] as above with mul weighting both axes, taken as they are
+    // for both directions, so they need not be antisymmetric; a pair is dropped when its terms are zero in both
+    static ConnectivityModel from_dense(const matrix_t& left, const matrix_t& same_x,
+                                        const matrix_t& up, const matrix_t& same_y,
+                                        const matrix_t& mul);
+};
@@ -0,0 +1,86 @@
+#include "cost_tensor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+void CostTensor::Free::operator()(long long* p) const {
+    munmap(p, bytes);
+}
+
+namespace {
+
+    void check_size(int n) {
+        if (n < 0 || (n > 0 && (size_t) n * n * n * n > CostTensor::MAX_ENTRIES)) {
+            throw std::runtime_error("Cost tensor too big");
+        }
+    }
+
+} // namespace
+
+CostTensor::CostTensor(int n, Order order, bool huge_pages) : n{n}, entry_order{order} {
+    check_size(n);
+    // mappings are page aligned, which covers ALIGNMENT
+    size_t bytes = std::max(entries() * sizeof(long long), ALIGNMENT);
+    if (huge_pages) {
+        bytes = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    }
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error("Cost tensor allocation failed");
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge_pages) {
+        madvise(memory, bytes, MADV_HUGEPAGE); // only advice, small pages if the kernel has none to give
+    }
+#endif
+    values = {static_cast<long long*>(memory), Free{bytes}};
+}
+
+CostTensor CostTensor::map_file(const std::string& path, size_t offset, int n, Order order) {
+    check_size(n);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("Cant open " + path);
+    }
+    CostTensor cost;
+    cost.n = n;
+    cost.entry_order = order;
+    size_t bytes = std::max(cost.entries() * sizeof(long long), ALIGNMENT);
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t) offset);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error("Cant map " + path);
+    }
+    cost.values = {static_cast<long long*>(memory), Free{bytes}};
+    return cost;
+}
+
+void CostTensor::check_symmetric() const {
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < n; ++k) {
+            const long long* ii = row(i, i, k);
+            for (int l = 0; l < n; ++l) {
+                if (ii[l] != 0) {
+                    throw std::runtime_error("Cost not zero diag");
+                }
+            }
+        }
+        for (int j = 0; j < n; ++j) {
+            for (int k = 0; k < n; ++k) {
+                const long long* ij = row(i, j, k);
+                if (ij[k] != 0) {
+                    throw std::runtime_error("Cost not zero diag");
+                }
+                for (int l = 0; l < n; ++l) {
+                    if (ij[l] != at(j, i, l, k)) {
+                        throw std::runtime_error("Cost not symmetric");
+                    }
+                }
+            }
+        }
+    }
+}
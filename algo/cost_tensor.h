@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+
+// QAP cost tensor: at(i, j, k, l) is the cost between i and j if pos[i] = k, pos[j] = l.
+// One zero-initialized 64-byte aligned block of n^4 entries, built in place by the caller through row()
+// and adopted by the ZD engines without a copy. Entries are in [i][j][k][l] or in [i][k][j][l] order,
+// in both the n entries of row(i, j, k) are contiguous.
+// The block is an anonymous mapping: its pages come zeroed and only the written ones get memory,
+// or a private mapping of a tensor stored in a file, whose pages are read in on first use.
+class CostTensor {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+    // larger tensors are refused
+    static constexpr size_t MAX_ENTRIES = std::numeric_limits<int>::max();
+    // huge page size the mapping is rounded up to when huge pages are asked for
+    static constexpr size_t HUGE_PAGE = 2 << 20;
+
+    // ijkl keeps the n^2 block of a device pair together. ikjl keeps the n^2 row of device i at slot k:
+    // the swap delta loops run over j with i and k fixed, they read one row instead of jumping n^2 entries.
+    enum class Order : int {
+        ijkl,
+        ikjl
+    };
+
+    CostTensor() = default;
+    // huge_pages asks the kernel to back the block with transparent huge pages, where it allows them
+    explicit CostTensor(int n, Order order = Order::ijkl, bool huge_pages = false);
+
+    // n^4 entries stored in the file at offset, a multiple of the page size
+    static CostTensor map_file(const std::string& path, size_t offset, int n, Order order = Order::ijkl);
+
+    [[nodiscard]] int size() const { return n; }
+    [[nodiscard]] Order order() const { return entry_order; }
+    [[nodiscard]] size_t entries() const { return (size_t) n * n * n * n; }
+
+    [[nodiscard]] long long* data() { return values.get(); }
+    [[nodiscard]] const long long* data() const { return values.get(); }
+
+    // strides of i, j and k, l is contiguous
+    [[nodiscard]] size_t stride_i() const { return (size_t) n * n * n; }
+    [[nodiscard]] size_t stride_j() const { return entry_order == Order::ijkl ? (size_t) n * n : n; }
+    [[nodiscard]] size_t stride_k() const { return entry_order == Order::ijkl ? n : (size_t) n * n; }
+
+    [[nodiscard]] size_t index(int i, int j, int k, int l) const {
+        return i * stride_i() + j * stride_j() + k * stride_k() + l;
+    }
+
+    // the n entries of (i, j, k), indexed l
+    [[nodiscard]] long long* row(int i, int j, int k) { return values.get() + index(i, j, k, 0); }
+    [[nodiscard]] const long long* row(int i, int j, int k) const { return values.get() + index(i, j, k, 0); }
+
+    long long& at(int i, int j, int k, int l) { return values[index(i, j, k, l)]; }
+    [[nodiscard]] long long at(int i, int j, int k, int l) const { return values[index(i, j, k, l)]; }
+
+    // throws unless at(i, i, k, l) == at(i, j, k, k) == 0 and at(i, j, k, l) == at(j, i, l, k)
+    void check_symmetric() const;
+
+private:
+    struct Free {
+        size_t bytes;
+        void operator()(long long* p) const;
+    };
+
+    int n{0};
+    Order entry_order{Order::ijkl};
+    std::unique_ptr<long long[], Free> values;
+};
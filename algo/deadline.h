@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+// When a solve has to stop: a time budget on the monotonic clock and a flag another thread may raise
+// to stop it early. clock() counts the CPU time of the whole process, so threads use a budget up
+// faster than it passes, and it is a system call where steady_clock is not.
+// Engines check the deadline between moves and return the best they have once it expired,
+// so a cancelled solve still gives a placement.
+class Deadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // moves between two clock reads of poll()
+    static constexpr int POLL_STRIDE = 64;
+
+    // seconds < 0 means no time limit, cancel may be null
+    explicit Deadline(double seconds = -1, const std::atomic<bool>* cancel = nullptr)
+            : start(Clock::now()), limited(seconds >= 0), cancel(cancel) {
+        if (limited) {
+            end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        }
+    }
+
+    // reads the clock, once expired stays expired
+    bool expired() {
+        if (!done) {
+            done = (cancel != nullptr && cancel->load(std::memory_order_relaxed)) || (limited && Clock::now() > end);
+        }
+        return done;
+    }
+
+    // expired() on every POLL_STRIDE-th call, for loops too short to read the clock on each pass
+    bool poll() {
+        if (done) {
+            return true;
+        }
+        if (++polls < POLL_STRIDE) {
+            return false;
+        }
+        polls = 0;
+        return expired();
+    }
+
+    [[nodiscard]] bool cancelled() const {
+        return cancel != nullptr && cancel->load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] long long elapsed_us() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    }
+
+    [[nodiscard]] double elapsed() const {
+        return (double) elapsed_us() / 1e6;
+    }
+
+private:
+    Clock::time_point start;
+    Clock::time_point end{};
+    bool limited;
+    const std::atomic<bool>* cancel;
+    int polls{0};
+    bool done{false};
+};
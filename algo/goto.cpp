@@ -4,20 +4,8 @@
 #include <cstring>
 #include <random>
 #include <queue>
-
-// random
-
-namespace Goto {
-
-    enum {
-        RANDOM_INT_LEFT = 0,
-        RANDOM_INT_RIGHT = 1000000000 - 1
-    };
-
-    std::default_random_engine random_gen{};
-    std::uniform_int_distribution<> int_dist(RANDOM_INT_LEFT, RANDOM_INT_RIGHT);
-
-}
+#include <algorithm>
+#include <stdexcept>
 
 void Goto::get_best_k(const ans_t *x, const ans_t *y, int n, int m, int *ans_i, int *ans_j, int k) {
     // size(x) = size(ans_i) = n
@@ -43,26 +31,27 @@ void Goto::get_best_k(const ans_t *x, const ans_t *y, int n, int m, int *ans_i,
     }
 }
 
-namespace Goto {
+using namespace Goto;
 
-    void set_seed(uint32_t seed) {
-        random_gen.seed(seed);
-    }
+// random
 
-    int rand_int(int l, int r) {
-        return int_dist(random_gen) % (r - l + 1) + l;
-    }
+void GotoHeurist::set_seed(uint32_t seed) {
+    random_gen.seed(seed);
+}
 
-} // namespace Goto
+int GotoHeurist::rand_int(int l, int r) {
+    return int_dist(random_gen) % (r - l + 1) + l;
+}
 
 // constructor
 
-using namespace Goto;
+GotoHeurist::GotoHeurist(int m_, int n_, int stepx, int stepy,
+                         const pin_acc_t& leftx, const pin_acc_t& samex,
+                         const pin_acc_t& upy, const pin_acc_t& samey,
+                         const mul_t& mul)
+        : GotoHeurist(m_, n_, stepx, stepy, ConnectivityModel::from_dense(leftx, samex, upy, samey, mul)) {}
 
-GotoHeurist::GotoHeurist(int m_, int n_, int stepx, int stepy, 
-                const pin_acc_t& leftx, const pin_acc_t& samex,
-                const pin_acc_t& upy, const pin_acc_t& samey,
-                const mul_t& mul) {
+GotoHeurist::GotoHeurist(int m_, int n_, int stepx, int stepy, const ConnectivityModel& model) {
     m = m_;
     n = n_;
     slots = m * n;
@@ -70,22 +59,34 @@ GotoHeurist::GotoHeurist(int m_, int n_, int stepx, int stepy,
     step_x = stepx;
     step_y = stepy;
 
-    allocate_permanent();
+    if (model.devices != devices) {
+        throw std::runtime_error("Connectivity size mismatch");
+    }
 
-    for (int i = 0; i < devices; ++i) {
-        for (int j = 0; j < devices; ++j) {
-            int q = idx_dev(i, j);
-            
-            left_x[q] = leftx[i][j];
-            same_x[q] = samex[i][j];
-            right_x[q] = leftx[j][i];
+    allocate_permanent();
 
-            up_y[q] = upy[i][j];
-            same_y[q] = samey[i][j];
-            down_y[q] = upy[j][i];
+    // one record per pair sharing a net, both adjacency entries point to it;
+    // right and down of (i, j) are left and up of (j, i), taken from the reverse edge
+    adj_start = new int[devices + 1];
+    adj = new int[model.edges()];
+    adj_pair = new int[model.edges()];
+    pairs = new PairRecord[model.edges() / 2];
+    std::copy(model.start.begin(), model.start.end(), adj_start);
+    std::copy(model.neighbor.begin(), model.neighbor.end(), adj);
 
-            w[q] = mul[i][j];
-        } 
+    int pair_count = 0;
+    for (int i = 0; i < devices; ++i) {
+        for (int e = model.start[i]; e < model.start[i + 1]; ++e) {
+            int j = model.neighbor[e];
+            if (j < i) {
+                continue;
+            }
+            int r = model.find(j, i);
+            const PairTerms& t = model.terms[e];
+            const PairTerms& rev = model.terms[r];
+            pairs[pair_count] = {t.mul_x, {t.left, t.same_x, rev.left}, t.mul_y, {rev.up, t.same_y, t.up}};
+            adj_pair[e] = adj_pair[r] = pair_count++;
+        }
     }
 
     for (int s = 0; s < slots; ++s) {
@@ -108,16 +109,6 @@ void GotoHeurist::allocate_permanent() {
     help_ans_i = new int[n];
     help_ans_j = new int[m];
 
-    w = new ans_t[slots * slots];
-
-    left_x = new ans_t[slots * slots];
-    same_x = new ans_t[slots * slots];
-    right_x = new ans_t[slots * slots];
-
-    up_y = new ans_t[slots * slots];
-    same_y = new ans_t[slots * slots];
-    down_y = new ans_t[slots * slots];
-
     pref_s_x = new ans_t[n];
     pref_s_y = new ans_t[m];
 
@@ -135,13 +126,10 @@ void GotoHeurist::allocate_permanent() {
 }
 
 void GotoHeurist::deallocate_permanent() {
-    delete[] left_x;
-    delete[] same_x;
-    delete[] right_x;
-
-    delete[] up_y;
-    delete[] same_y;
-    delete[] down_y;
+    delete[] adj_start;
+    delete[] adj;
+    delete[] adj_pair;
+    delete[] pairs;
 
     delete[] pref_s_x;
     delete[] pref_s_y;
@@ -201,10 +189,8 @@ GotoHeurist::Solution GotoHeurist::SORG() {
     std::memset(IOC, 0, devices * sizeof(ans_t));
 
     for (int i = 0; i < devices; ++i) {
-        for (int j = 0; j < devices; ++j) {
-            if (i != j) {
-                IOC[i] -= w[idx_dev(i, j)];
-            }
+        for (int e = adj_start[i]; e < adj_start[i + 1]; ++e) {
+            IOC[i] -= pairs[adj_pair[e]].wx + pairs[adj_pair[e]].wy;
         }
     }
 
@@ -245,11 +231,12 @@ GotoHeurist::Solution GotoHeurist::SORG() {
                 continue;
             }
             ans_t cost{0};
-            for (int d = 0; d < devices; ++d) {
+            for (int e = adj_start[dev]; e < adj_start[dev + 1]; ++e) {
+                int d = adj[e];
                 if (!is_placed[d]) {
                     continue;
                 }
-                cost += contrib(d, dev, sol.perm[d], j);
+                cost += contrib(pairs[adj_pair[e]], d > dev, sol.perm[d], j);
             }
             if (slot == -1 || cost < best_cost) {
                 slot = j;
@@ -262,13 +249,11 @@ GotoHeurist::Solution GotoHeurist::SORG() {
         sol.perm[dev] = slot;
         sol.rev_perm[slot] = dev;
 
-        for (int j = 0; j < devices; ++j) {
-            if (j != dev) {
-                IOC[j] += w[idx_dev(dev, j)];
-            }
+        for (int e = adj_start[dev]; e < adj_start[dev + 1]; ++e) {
+            IOC[adj[e]] += pairs[adj_pair[e]].wx + pairs[adj_pair[e]].wy;
         }
 
-    } // O(devices^3)
+    } // O(devices^2 * degree)
 
     sol.twl = calc_twl(sol);
 
@@ -282,10 +267,6 @@ int GotoHeurist::idx(int i, int j) const {
     return i * n + j;
 }
 
-int GotoHeurist::idx_dev(int i, int j) const {
-    return i * devices + j;
-}
-
 // GFDR
 bool GotoHeurist::GFDR(GotoHeurist::Solution& sol, int device) { // improvement for the device
 //    get_median_1(sol, device);
@@ -355,8 +336,11 @@ void GotoHeurist::copy(const GotoHeurist::Solution &from, GotoHeurist::Solution
 ans_t GotoHeurist::calc_twl(const GotoHeurist::Solution &sol) const {
     ans_t twl{0};
     for (int i = 0; i < devices; ++i) {
-        for (int j = i + 1; j < devices; ++j) {
-            twl += contrib(i, j, sol.perm[i], sol.perm[j]);
+        for (int e = adj_start[i]; e < adj_start[i + 1]; ++e) {
+            int j = adj[e];
+            if (j > i) {
+                twl += contrib(pairs[adj_pair[e]], 0, sol.perm[i], sol.perm[j]);
+            }
         }
     }
     return twl;
@@ -375,37 +359,59 @@ ans_t GotoHeurist::delta(const GotoHeurist::Solution &sol, int i, int j) const {
     ans_t ret{0};
     int pos_i = sol.perm[i];
     int pos_j = sol.perm[j];
-    for (int q = 0; q < devices; ++q) {
-        if (q == i || q == j) {
-            continue;
+    // only devices sharing a net with i or j change their contribution
+    for (int e = adj_start[i]; e < adj_start[i + 1]; ++e) {
+        int q = adj[e];
+        if (q != j) {
+            int pos_q = sol.perm[q];
+            const PairRecord &pair = pairs[adj_pair[e]];
+            ret += contrib(pair, i > q, pos_j, pos_q) - contrib(pair, i > q, pos_i, pos_q);
+        }
+    }
+    for (int e = adj_start[j]; e < adj_start[j + 1]; ++e) {
+        int q = adj[e];
+        if (q != i) {
+            int pos_q = sol.perm[q];
+            const PairRecord &pair = pairs[adj_pair[e]];
+            ret += contrib(pair, j > q, pos_i, pos_q) - contrib(pair, j > q, pos_j, pos_q);
         }
-        int pos_q = sol.perm[q];
-        ret += contrib(i, q, pos_j, pos_q) - contrib(i, q, pos_i, pos_q)
-                + contrib(j, q, pos_i, pos_q) - contrib(j, q, pos_j, pos_q);
     }
     ret += contrib(i, j, pos_j, pos_i) - contrib(i, j, pos_i, pos_j);
     return ret;
 }
 
+ans_t GotoHeurist::swap_delta(const std::vector<int> &perm, int i, int j) const {
+    Solution sol{const_cast<int *>(perm.data()), nullptr, 0}; // delta reads perm only
+    return delta(sol, i, j);
+}
+
 ans_t GotoHeurist::contrib(int i, int j, int pos_i, int pos_j) const {
     if (i == j) {
         return 0;
     }
-    return contrib(i, j, loc_x[pos_i], loc_x[pos_j], loc_y[pos_i], loc_y[pos_j]);
-}
-
-ans_t GotoHeurist::contrib(int i, int j, int xi, int xj, int yi, int yj) const {
-    return contrib_x(i, j, xi, xj) + contrib_y(i, j, yi, yj);
+    int e = find_pair(i, j);
+    if (e == -1) {
+        return 0;
+    }
+    return contrib(pairs[adj_pair[e]], i > j, pos_i, pos_j);
 }
 
-ans_t GotoHeurist::contrib_x(int i, int j, int xi, int xj) const {
-    int pair_id = idx_dev(i, j);
-    return w[pair_id] * abs(xi - xj) + (xi == xj ? same_x[pair_id] : (xi < xj ? left_x[pair_id] : right_x[pair_id]));
+ans_t GotoHeurist::contrib(const PairRecord &pair, int flip, int pos_i, int pos_j) const {
+    int dx = loc_x[pos_i] - loc_x[pos_j];
+    int dy = loc_y[pos_i] - loc_y[pos_j];
+    // sign of the difference as seen from the lower device of the pair
+    int sx = (dx > 0) - (dx < 0);
+    int sy = (dy > 0) - (dy < 0);
+    sx -= 2 * flip * sx;
+    sy -= 2 * flip * sy;
+    return pair.wx * std::abs(dx) + pair.x[sx + 1] + pair.wy * std::abs(dy) + pair.y[sy + 1];
 }
 
-ans_t GotoHeurist::contrib_y(int i, int j, int yi, int yj) const {
-    int pair_id = idx_dev(i, j);
-    return w[pair_id] * abs(yi - yj) + (yi == yj ? same_y[pair_id] : (yi < yj ? down_y[pair_id] : up_y[pair_id]));
+int GotoHeurist::find_pair(int i, int j) const {
+    const int *first = adj + adj_start[i];
+    const int *last = adj + adj_start[i + 1];
+    const int *it = std::lower_bound(first, last, j);
+    return it != last && *it == j ? (int) (it - adj) : -1;
 }
 
 void GotoHeurist::get_vals(ans_t *vals, int N, int step, const ans_t *pref_w, const ans_t *pref_s) {
@@ -424,42 +430,42 @@ void GotoHeurist::get_median(const GotoHeurist::Solution &sol, int device) {
     std::memset(pref_w_x, 0, sizeof(ans_t) * n);
     std::memset(pref_w_y, 0, sizeof(ans_t) * m);
 
-    for (int i = 0; i < devices; ++i) {
-        if (i == device) {
-            continue;
-        }
+    for (int e = adj_start[device]; e < adj_start[device + 1]; ++e) {
+        int i = adj[e];
 
-        int pair_id = idx_dev(device, i);
-        ans_t cur_w = w[pair_id];
+        // terms of (device, i): left/down at lo, right/up at hi
+        const PairRecord &pair = pairs[adj_pair[e]];
+        int lo = device > i ? 2 : 0;
+        int hi = 2 - lo;
 
         int xi = sol.perm[i] % n; // < n
         int yi = sol.perm[i] / n; // < m
 
         {
-            pref_w_x[0] -= cur_w;
-            pref_w_x[xi] += cur_w;
+            pref_w_x[0] -= pair.wx;
+            pref_w_x[xi] += pair.wx;
             if (xi + 1 < n) {
-                pref_w_x[xi + 1] += cur_w;
+                pref_w_x[xi + 1] += pair.wx;
             }
 
-            pref_s_x[0] += step_x * xi * cur_w + left_x[pair_id];
-            pref_s_x[xi] += -step_x * xi * cur_w - left_x[pair_id] + same_x[pair_id];
+            pref_s_x[0] += step_x * xi * pair.wx + pair.x[lo];
+            pref_s_x[xi] += -step_x * xi * pair.wx - pair.x[lo] + pair.x[1];
             if (xi + 1 < n) {
-                pref_s_x[xi + 1] += -step_x * xi * cur_w - same_x[pair_id] + right_x[pair_id];
+                pref_s_x[xi + 1] += -step_x * xi * pair.wx - pair.x[1] + pair.x[hi];
             }
         }
 
         {
-            pref_w_y[0] -= cur_w;
-            pref_w_y[yi] += cur_w;
+            pref_w_y[0] -= pair.wy;
+            pref_w_y[yi] += pair.wy;
             if (yi + 1 < m) {
-                pref_w_y[yi + 1] += cur_w;
+                pref_w_y[yi + 1] += pair.wy;
             }
 
-            pref_s_y[0] += step_y * yi * cur_w + down_y[pair_id];
-            pref_s_y[yi] += -step_y * yi * cur_w - down_y[pair_id] + same_y[pair_id];
+            pref_s_y[0] += step_y * yi * pair.wy + pair.y[lo];
+            pref_s_y[yi] += -step_y * yi * pair.wy - pair.y[lo] + pair.y[1];
             if (yi + 1 < m) {
-                pref_s_y[yi + 1] += -step_y * yi * cur_w - same_y[pair_id] + up_y[pair_id];
+                pref_s_y[yi + 1] += -step_y * yi * pair.wy - pair.y[1] + pair.y[hi];
             }
         }
     }
@@ -500,12 +506,16 @@ std::vector<std::pair<double, std::vector<int>>> GotoHeurist::get_debug_info() c
 }
 
 bool GotoHeurist::need_udpate() const {
-    return debug_interval != -1 && (int)(clock() - last_time) >= debug_interval;
+    return debug_interval != -1 && deadline.elapsed_us() - last_time >= debug_interval;
 }
 
 void GotoHeurist::update() {
-    debug_info.emplace_back((clock() - start_time) / 1e6, std::vector<int>{best.perm, best.perm + devices});
-    last_time = clock();
+    last_time = deadline.elapsed_us();
+    debug_info.emplace_back(last_time / 1e6, std::vector<int>{best.perm, best.perm + devices});
+}
+
+void GotoHeurist::set_cancel(const std::atomic<bool> *flag) {
+    cancel = flag;
 }
 
 std::vector<int> GotoHeurist::solve(int lambda_max_param, int eps_param, double time, double deb_interval, int seed) {
@@ -524,11 +534,10 @@ std::vector<int> GotoHeurist::solve(int lambda_max_param, int eps_param, double
     eps = std::min(eps_param, m * n);
     lambda_max = lambda_max_param;
 
-    auto max_time = (clock_t)(time * 1e6);
-
     debug_info.clear();
 
-    start_time = last_time = clock();
+    deadline = Deadline(time, cancel);
+    last_time = 0;
 
     allocate_temp();
 
@@ -536,14 +545,14 @@ std::vector<int> GotoHeurist::solve(int lambda_max_param, int eps_param, double
         update();
     }
 
-    while ((clock() - start_time) <= max_time) {
+    while (!deadline.expired()) {
 
         if (need_udpate()) {
             update();
         }
 
         Solution initial{SORG()};
-        for (int d = 0; d < devices; ++d) {
+        for (int d = 0; d < devices && !deadline.poll(); ++d) {
             GFDR(initial, d);
             if (initial.twl < best.twl) {
                 copy(initial, best);
@@ -575,10 +584,9 @@ void GotoHeurist::print_sol(const GotoHeurist::Solution &sol) const {
 
 ans_t GotoHeurist::contrib(const Solution& sol, int device) const {
     ans_t ret{0};
-    for (int i = 0; i < devices; ++i) {
-        if (i != device) {
-            ret += contrib(device, i, sol.perm[device], sol.perm[i]);
-        }
+    for (int e = adj_start[device]; e < adj_start[device + 1]; ++e) {
+        int i = adj[e];
+        ret += contrib(pairs[adj_pair[e]], device > i, sol.perm[device], sol.perm[i]);
     }
     return ret;
 }
@@ -601,11 +609,10 @@ GotoHeurist::Solution GotoHeurist::SORG1() {
 void GotoHeurist::get_median_1(const GotoHeurist::Solution &sol, int device) {
     std::vector<ans_t> contr(slots, 0);
     for (int i = 0; i < slots; ++i) {
-        for (int d = 0; d < devices; ++d) {
-            if (d != device) {
-                ans_t cur_contr = contrib(device, d, i, sol.perm[d]);
-                contr[i] += cur_contr;
-            }
+        for (int e = adj_start[device]; e < adj_start[device + 1]; ++e) {
+            int d = adj[e];
+            ans_t cur_contr = contrib(pairs[adj_pair[e]], device > d, i, sol.perm[d]);
+            contr[i] += cur_contr;
         }
     }
     std::vector<int> S(slots);
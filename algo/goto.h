@@ -1,5 +1,10 @@
+#include "connectivity.h"
+#include "deadline.h"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
 #include <vector>
-#include <ctime>
 
 namespace Goto {
 
@@ -36,6 +41,9 @@ namespace Goto {
                     const pin_acc_t &upy, const pin_acc_t &samey,
                     const mul_t &mul); // mul is symmetric matrix, mut[i][i] = 0
 
+        // devices must equal m * n, pair arrays are filled from the sparse edges
+        GotoHeurist(int m, int n, int stepx, int stepy, const ConnectivityModel &model);
+
         ~GotoHeurist();
 
         // returns perm where i-th device is located in the perm[i]-th location
@@ -44,6 +52,12 @@ namespace Goto {
         // returns array debug_info, where debug_info[i] = {time, best_form_perm}
         [[nodiscard]] std::vector<std::pair<double, std::vector<int>>> get_debug_info() const;
 
+        // solve returns its best so far once cancel is raised, null for none
+        void set_cancel(const std::atomic<bool> *flag);
+
+        // twl change after swapping devices i and j of perm, O(degree of i and j)
+        [[nodiscard]] ans_t swap_delta(const std::vector<int> &perm, int i, int j) const;
+
     private:
         int lambda_max{}; // >= 2
         int eps{}; // >= 1
@@ -54,11 +68,22 @@ namespace Goto {
         int step_x, step_y;
 
         [[nodiscard]] int idx(int i, int j) const; // i * n + j
-        [[nodiscard]] int idx_dev(int i, int j) const; // i * devices + j
+        // coefficients of a pair i < j in one cache line, indexed by sign(coord_i - coord_j) + 1
+        struct alignas(64) PairRecord {
+            ans_t wx; // mult for dist between centers along x
+            ans_t x[3]; // contribution of pins if i [left/same/right] than j
+            ans_t wy; // along y
+            ans_t y[3]; // contribution of pins if i [down/same/up] than j
+        };
+
+        // devices sharing a net with i are adj[adj_start[i]..adj_start[i + 1]), the pair terms of all
+        // other devices are zero, so per-device kernels run in O(degree) instead of O(devices)
+        int *adj_start{}; // size = devices + 1
+        int *adj{};
+        int *adj_pair{}; // record of the pair (i, adj[e]) in pairs
+        PairRecord *pairs{}; // one per pair sharing a net
 
-        ans_t *left_x{}, *same_x{}, *right_x{}; // contribution of pins if i [left/same/right] than j
-        ans_t *up_y{}, *same_y{}, *down_y{}; // contribution of pins if i [up/same/down] than j
-        ans_t *w{}; // mult for dist between centers
+        [[nodiscard]] int find_pair(int i, int j) const; // adjacency index of j in the list of i or -1
 
         // Generalized-Force-Directed relaxation
         bool GFDR(Solution &sol, int i); // start local update from i-th device
@@ -66,11 +91,8 @@ namespace Goto {
         void swap(Solution &sol, int i, int j, ans_t twl_delta); // swap i, j and update sol
         [[nodiscard]] ans_t delta(const Solution &sol, int i, int j) const;
 
-        [[nodiscard]] ans_t contrib_x(int i, int j, int xi, int xj) const;
-
-        [[nodiscard]] ans_t contrib_y(int i, int j, int yi, int yj) const;
-
-        [[nodiscard]] ans_t contrib(int i, int j, int xi, int xj, int yi, int yj) const;
+        // flip = i > j, i.e. i is the upper device of the pair; no branches on the coordinates
+        [[nodiscard]] ans_t contrib(const PairRecord &pair, int flip, int pos_i, int pos_j) const;
 
         [[nodiscard]] ans_t contrib(int i, int j, int pos_i, int pos_j) const;
 
@@ -88,9 +110,22 @@ namespace Goto {
 
         Solution SORG1();
 
+        // random, one generator per engine, so solves on other threads do not touch it and a seed
+        // repeats its run
+        enum {
+            RANDOM_INT_LEFT = 0,
+            RANDOM_INT_RIGHT = 1000000000 - 1
+        };
+        std::default_random_engine random_gen{};
+        std::uniform_int_distribution<> int_dist{RANDOM_INT_LEFT, RANDOM_INT_RIGHT};
+
+        void set_seed(uint32_t seed);
+        int rand_int(int l, int r); // in [l, r]
+
         // debug
-        clock_t start_time{}; // starts with solve()
-        clock_t last_time{};
+        Deadline deadline; // starts with solve()
+        const std::atomic<bool> *cancel{nullptr};
+        long long last_time{}; // microseconds of deadline
         std::vector<std::pair<double, std::vector<int>>> debug_info{}; // clear with solve()
         [[nodiscard]] bool need_udpate() const;
 
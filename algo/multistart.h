@@ -0,0 +1,67 @@
+#pragma once
+
+#include "parallel.h"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Independent restarts side by side, one worker per thread, each drawing the seeds of its restarts from
+// its own stream. The least score so far is shared through an atomic, a worker copies a permutation
+// only when it is not worse. Of equal scores the lower worker and then its earlier restart wins, so for
+// a seed, a worker count and the restarts each worker runs the result does not depend on thread timing.
+namespace multistart {
+
+    struct Best {
+        std::vector<int> p; // empty if no restart ran
+        double score{1e18};
+        int worker{-1};
+    };
+
+    // seeds of the restarts of worker w; worker 0 draws from the seed itself, as one serial run did
+    inline std::mt19937 worker_stream(int seed, int worker) {
+        if (worker == 0) {
+            return std::mt19937{(uint32_t) seed};
+        }
+        std::seed_seq stream{(uint32_t) seed, (uint32_t) worker};
+        return std::mt19937{stream};
+    }
+
+    // restart(w, seed) returns a permutation and its score, more(w, done) tells whether worker w starts
+    // another after done restarts; both run on the thread of worker w only, so they may use its state
+    // unlocked. Worker 0 runs its first restart without asking, so there is a result.
+    template<typename Restart, typename More>
+    Best run(int workers, int seed, Restart&& restart, More&& more) {
+        std::vector<Best> results(workers);
+        std::atomic<double> incumbent{1e18};
+
+        parallel::for_each_index(workers, workers, [&](int w) {
+            std::mt19937 rnd = worker_stream(seed, w);
+            Best& own = results[w];
+            int done = 0;
+            while ((w == 0 && done == 0) || more(w, done)) {
+                std::pair<std::vector<int>, double> cur = restart(w, (int) rnd());
+                ++done;
+                double score = cur.second;
+                double seen = incumbent.load();
+                while (score < seen && !incumbent.compare_exchange_weak(seen, score)) {
+                }
+                // score <= seen: it is the least so far, or ties it
+                if (score <= seen && score < own.score) {
+                    own = {std::move(cur.first), score, w};
+                }
+            }
+        });
+
+        Best best;
+        for (Best& result : results) {
+            if (!result.p.empty() && result.score < best.score) {
+                best = std::move(result);
+            }
+        }
+        return best;
+    }
+
+} // namespace multistart
@@ -4,21 +4,8 @@
 #include <cstring>
 #include <random>
 #include <queue>
-
-// random
-
-namespace NewGoto {
-
-    enum {
-        RANDOM_INT_LEFT = 0,
-        RANDOM_INT_RIGHT = 1000000000 - 1
-    };
-
-    std::default_random_engine random_gen{};
-    std::uniform_int_distribution<> int_dist(RANDOM_INT_LEFT, RANDOM_INT_RIGHT);
-    std::uniform_real_distribution<> real_dist(0, 1);
-
-} // namespace NewGoto
+#include <algorithm>
+#include <stdexcept>
 
 void NewGoto::get_best_k(const ans_t *x, const ans_t *y, int n, int m, int *ans_i, int *ans_j, int k) {
     // size(x) = size(ans_i) = n
@@ -44,30 +31,31 @@ void NewGoto::get_best_k(const ans_t *x, const ans_t *y, int n, int m, int *ans_
     }
 }
 
-namespace NewGoto {
-
-    void set_seed(uint32_t seed) {
-        random_gen.seed(seed);
-    }
+using namespace NewGoto;
 
-    int rand_int(int l, int r) {
-        return int_dist(random_gen) % (r - l + 1) + l;
-    }
+// random
 
-    float rand_real() {
-        return real_dist(random_gen);
-    }
+void NewGotoHeurist::set_seed(uint32_t seed) {
+    random_gen.seed(seed);
+}
 
-} // namespace NewGoto
+int NewGotoHeurist::rand_int(int l, int r) {
+    return int_dist(random_gen) % (r - l + 1) + l;
+}
 
-using namespace NewGoto;
+float NewGotoHeurist::rand_real() {
+    return real_dist(random_gen);
+}
 
 // constructor
 
 NewGotoHeurist::NewGotoHeurist(int m_, int n_, int stepx, int stepy,
                          const pin_acc_t& leftx, const pin_acc_t& samex,
                          const pin_acc_t& upy, const pin_acc_t& samey,
-                         const mul_t& mul) {
+                         const mul_t& mul)
+        : NewGotoHeurist(m_, n_, stepx, stepy, ConnectivityModel::from_dense(leftx, samex, upy, samey, mul)) {}
+
+NewGotoHeurist::NewGotoHeurist(int m_, int n_, int stepx, int stepy, const ConnectivityModel& model) {
     m = m_;
     n = n_;
     slots = m * n;
@@ -75,21 +63,33 @@ NewGotoHeurist::NewGotoHeurist(int m_, int n_, int stepx, int stepy,
     step_x = stepx;
     step_y = stepy;
 
-    allocate_permanent();
-
-    for (int i = 0; i < devices; ++i) {
-        for (int j = 0; j < devices; ++j) {
-            int q = idx_dev(i, j);
+    if (model.devices != devices) {
+        throw std::runtime_error("Connectivity size mismatch");
+    }
 
-            left_x[q] = leftx[i][j];
-            same_x[q] = samex[i][j];
-            right_x[q] = leftx[j][i];
+    allocate_permanent();
 
-            up_y[q] = upy[i][j];
-            same_y[q] = samey[i][j];
-            down_y[q] = upy[j][i];
+    // one record per pair sharing a net, both adjacency entries point to it;
+    // right and down of (i, j) are left and up of (j, i), taken from the reverse edge
+    adj_start = new int[devices + 1];
+    adj = new int[model.edges()];
+    adj_pair = new int[model.edges()];
+    pairs = new PairRecord[model.edges() / 2];
+    std::copy(model.start.begin(), model.start.end(), adj_start);
+    std::copy(model.neighbor.begin(), model.neighbor.end(), adj);
 
-            w[q] = mul[i][j];
+    int pair_count = 0;
+    for (int i = 0; i < devices; ++i) {
+        for (int e = model.start[i]; e < model.start[i + 1]; ++e) {
+            int j = model.neighbor[e];
+            if (j < i) {
+                continue;
+            }
+            int r = model.find(j, i);
+            const PairTerms& t = model.terms[e];
+            const PairTerms& rev = model.terms[r];
+            pairs[pair_count] = {t.mul_x, {t.left, t.same_x, rev.left}, t.mul_y, {rev.up, t.same_y, t.up}};
+            adj_pair[e] = adj_pair[r] = pair_count++;
         }
     }
 
@@ -113,16 +113,6 @@ void NewGotoHeurist::allocate_permanent() {
     help_ans_i = new int[n];
     help_ans_j = new int[m];
 
-    w = new ans_t[slots * slots];
-
-    left_x = new ans_t[slots * slots];
-    same_x = new ans_t[slots * slots];
-    right_x = new ans_t[slots * slots];
-
-    up_y = new ans_t[slots * slots];
-    same_y = new ans_t[slots * slots];
-    down_y = new ans_t[slots * slots];
-
     pref_s_x = new ans_t[n];
     pref_s_y = new ans_t[m];
 
@@ -141,13 +131,10 @@ void NewGotoHeurist::allocate_permanent() {
 }
 
 void NewGotoHeurist::deallocate_permanent() {
-    delete[] left_x;
-    delete[] same_x;
-    delete[] right_x;
-
-    delete[] up_y;
-    delete[] same_y;
-    delete[] down_y;
+    delete[] adj_start;
+    delete[] adj;
+    delete[] adj_pair;
+    delete[] pairs;
 
     delete[] pref_s_x;
     delete[] pref_s_y;
@@ -226,10 +213,6 @@ int NewGotoHeurist::idx(int i, int j) const {
     return i * n + j;
 }
 
-int NewGotoHeurist::idx_dev(int i, int j) const {
-    return i * devices + j;
-}
-
 // GFDR
 bool NewGotoHeurist::GFDR(NewGotoHeurist::Solution& sol, int device) { // improvement for the device
 //    get_median_1(sol, device);
@@ -305,8 +288,11 @@ void NewGotoHeurist::copy(const NewGotoHeurist::Solution &from, NewGotoHeurist::
 ans_t NewGotoHeurist::calc_twl(const NewGotoHeurist::Solution &sol) const {
     ans_t twl{0};
     for (int i = 0; i < devices; ++i) {
-        for (int j = i + 1; j < devices; ++j) {
-            twl += contrib(i, j, sol.perm[i], sol.perm[j]);
+        for (int e = adj_start[i]; e < adj_start[i + 1]; ++e) {
+            int j = adj[e];
+            if (j > i) {
+                twl += contrib(pairs[adj_pair[e]], 0, sol.perm[i], sol.perm[j]);
+            }
         }
     }
     return twl;
@@ -325,13 +311,22 @@ ans_t NewGotoHeurist::delta(const NewGotoHeurist::Solution &sol, int i, int j) c
     ans_t ret{0};
     int pos_i = sol.perm[i];
     int pos_j = sol.perm[j];
-    for (int q = 0; q < devices; ++q) {
-        if (q == i || q == j) {
-            continue;
+    // only devices sharing a net with i or j change their contribution
+    for (int e = adj_start[i]; e < adj_start[i + 1]; ++e) {
+        int q = adj[e];
+        if (q != j) {
+            int pos_q = sol.perm[q];
+            const PairRecord &pair = pairs[adj_pair[e]];
+            ret += contrib(pair, i > q, pos_j, pos_q) - contrib(pair, i > q, pos_i, pos_q);
+        }
+    }
+    for (int e = adj_start[j]; e < adj_start[j + 1]; ++e) {
+        int q = adj[e];
+        if (q != i) {
+            int pos_q = sol.perm[q];
+            const PairRecord &pair = pairs[adj_pair[e]];
+            ret += contrib(pair, j > q, pos_i, pos_q) - contrib(pair, j > q, pos_j, pos_q);
         }
-        int pos_q = sol.perm[q];
-        ret += contrib(i, q, pos_j, pos_q) - contrib(i, q, pos_i, pos_q)
-               + contrib(j, q, pos_i, pos_q) - contrib(j, q, pos_j, pos_q);
     }
     ret += contrib(i, j, pos_j, pos_i) - contrib(i, j, pos_i, pos_j);
     return ret;
@@ -341,21 +336,29 @@ ans_t NewGotoHeurist::contrib(int i, int j, int pos_i, int pos_j) const {
     if (i == j) {
         return 0;
     }
-    return contrib(i, j, loc_x[pos_i], loc_x[pos_j], loc_y[pos_i], loc_y[pos_j]);
-}
-
-ans_t NewGotoHeurist::contrib(int i, int j, int xi, int xj, int yi, int yj) const {
-    return contrib_x(i, j, xi, xj) + contrib_y(i, j, yi, yj);
+    int e = find_pair(i, j);
+    if (e == -1) {
+        return 0;
+    }
+    return contrib(pairs[adj_pair[e]], i > j, pos_i, pos_j);
 }
 
-ans_t NewGotoHeurist::contrib_x(int i, int j, int xi, int xj) const {
-    int pair_id = idx_dev(i, j);
-    return w[pair_id] * abs(xi - xj) + (xi == xj ? same_x[pair_id] : (xi < xj ? left_x[pair_id] : right_x[pair_id]));
+ans_t NewGotoHeurist::contrib(const PairRecord &pair, int flip, int pos_i, int pos_j) const {
+    int dx = loc_x[pos_i] - loc_x[pos_j];
+    int dy = loc_y[pos_i] - loc_y[pos_j];
+    // sign of the difference as seen from the lower device of the pair
+    int sx = (dx > 0) - (dx < 0);
+    int sy = (dy > 0) - (dy < 0);
+    sx -= 2 * flip * sx;
+    sy -= 2 * flip * sy;
+    return pair.wx * std::abs(dx) + pair.x[sx + 1] + pair.wy * std::abs(dy) + pair.y[sy + 1];
 }
 
-ans_t NewGotoHeurist::contrib_y(int i, int j, int yi, int yj) const {
-    int pair_id = idx_dev(i, j);
-    return w[pair_id] * abs(yi - yj) + (yi == yj ? same_y[pair_id] : (yi < yj ? down_y[pair_id] : up_y[pair_id]));
+int NewGotoHeurist::find_pair(int i, int j) const {
+    const int *first = adj + adj_start[i];
+    const int *last = adj + adj_start[i + 1];
+    const int *it = std::lower_bound(first, last, j);
+    return it != last && *it == j ? (int) (it - adj) : -1;
 }
 
 void NewGotoHeurist::get_vals(ans_t *vals, int N, int step, const ans_t *pref_w, const ans_t *pref_s) {
@@ -374,42 +377,42 @@ void NewGotoHeurist::get_median(const NewGotoHeurist::Solution &sol, int device)
     std::memset(pref_w_x, 0, sizeof(ans_t) * n);
     std::memset(pref_w_y, 0, sizeof(ans_t) * m);
 
-    for (int i = 0; i < devices; ++i) {
-        if (i == device) {
-            continue;
-        }
+    for (int e = adj_start[device]; e < adj_start[device + 1]; ++e) {
+        int i = adj[e];
 
-        int pair_id = idx_dev(device, i);
-        ans_t cur_w = w[pair_id];
+        // terms of (device, i): left/down at lo, right/up at hi
+        const PairRecord &pair = pairs[adj_pair[e]];
+        int lo = device > i ? 2 : 0;
+        int hi = 2 - lo;
 
         int xi = sol.perm[i] % n; // < n
         int yi = sol.perm[i] / n; // < m
 
         {
-            pref_w_x[0] -= cur_w;
-            pref_w_x[xi] += cur_w;
+            pref_w_x[0] -= pair.wx;
+            pref_w_x[xi] += pair.wx;
             if (xi + 1 < n) {
-                pref_w_x[xi + 1] += cur_w;
+                pref_w_x[xi + 1] += pair.wx;
             }
 
-            pref_s_x[0] += step_x * xi * cur_w + left_x[pair_id];
-            pref_s_x[xi] += -step_x * xi * cur_w - left_x[pair_id] + same_x[pair_id];
+            pref_s_x[0] += step_x * xi * pair.wx + pair.x[lo];
+            pref_s_x[xi] += -step_x * xi * pair.wx - pair.x[lo] + pair.x[1];
             if (xi + 1 < n) {
-                pref_s_x[xi + 1] += -step_x * xi * cur_w - same_x[pair_id] + right_x[pair_id];
+                pref_s_x[xi + 1] += -step_x * xi * pair.wx - pair.x[1] + pair.x[hi];
             }
         }
 
         {
-            pref_w_y[0] -= cur_w;
-            pref_w_y[yi] += cur_w;
+            pref_w_y[0] -= pair.wy;
+            pref_w_y[yi] += pair.wy;
             if (yi + 1 < m) {
-                pref_w_y[yi + 1] += cur_w;
+                pref_w_y[yi + 1] += pair.wy;
             }
 
-            pref_s_y[0] += step_y * yi * cur_w + down_y[pair_id];
-            pref_s_y[yi] += -step_y * yi * cur_w - down_y[pair_id] + same_y[pair_id];
+            pref_s_y[0] += step_y * yi * pair.wy + pair.y[lo];
+            pref_s_y[yi] += -step_y * yi * pair.wy - pair.y[lo] + pair.y[1];
             if (yi + 1 < m) {
-                pref_s_y[yi + 1] += -step_y * yi * cur_w - same_y[pair_id] + up_y[pair_id];
+                pref_s_y[yi + 1] += -step_y * yi * pair.wy - pair.y[1] + pair.y[hi];
             }
         }
     }
@@ -445,12 +448,16 @@ std::vector<std::pair<double, std::vector<int>>> NewGotoHeurist::get_debug_info(
 }
 
 bool NewGotoHeurist::need_udpate() const {
-    return debug_interval != -1 && (int)(clock() - last_time) >= debug_interval;
+    return debug_interval != -1 && deadline.elapsed_us() - last_time >= debug_interval;
 }
 
 void NewGotoHeurist::update() {
-    debug_info.emplace_back((clock() - start_time) / 1e6, std::vector<int>{best.perm, best.perm + devices});
-    last_time = clock();
+    last_time = deadline.elapsed_us();
+    debug_info.emplace_back(last_time / 1e6, std::vector<int>{best.perm, best.perm + devices});
+}
+
+void NewGotoHeurist::set_cancel(const std::atomic<bool> *flag) {
+    cancel = flag;
 }
 
 std::vector<int> NewGotoHeurist::solve(int n1_param, int n2_param, int S_param, int z_param, int lambda_max_param, int eps_param, double time, double deb_interval, int seed) {
@@ -477,11 +484,10 @@ std::vector<int> NewGotoHeurist::solve(int n1_param, int n2_param, int S_param,
     printf("new_goto: seed=%d, debug_interval=%d, "
            "m=%d, n=%d, n1=%d, n2=%d, S=%d, top=%d, eps=%d, lambda=%d\n", seed, debug_interval, m, n, n1, n2, S, top, eps, lambda_max);
 
-    auto max_time = (clock_t)(time * 1e6);
-
     debug_info.clear();
 
-    start_time = last_time = clock();
+    deadline = Deadline(time, cancel);
+    last_time = 0;
 
     allocate_temp();
 
@@ -491,7 +497,7 @@ std::vector<int> NewGotoHeurist::solve(int n1_param, int n2_param, int S_param,
         update();
     }
 
-    while ((clock() - start_time) <= max_time) {
+    while (!deadline.expired()) {
         sort_M();
         upd_best();
 
@@ -533,10 +539,9 @@ void NewGotoHeurist::print_sol(const NewGotoHeurist::Solution &sol) const {
 
 ans_t NewGotoHeurist::contrib(const Solution& sol, int device) const {
     ans_t ret{0};
-    for (int i = 0; i < devices; ++i) {
-        if (i != device) {
-            ret += contrib(device, i, sol.perm[device], sol.perm[i]);
-        }
+    for (int e = adj_start[device]; e < adj_start[device + 1]; ++e) {
+        int i = adj[e];
+        ret += contrib(pairs[adj_pair[e]], device > i, sol.perm[device], sol.perm[i]);
     }
     return ret;
 }
@@ -549,7 +554,7 @@ void NewGotoHeurist::rand_sol(Solution& s) {
     s.twl = calc_twl(s);
 }
 
-void NewGotoHeurist::rand_prior(float *prior) const {
+void NewGotoHeurist::rand_prior(float *prior) {
     for (int i = 0; i < devices; ++i) {
         prior[i] = rand_real();
     }
@@ -709,6 +714,9 @@ void NewGotoHeurist::gark3(int cnt, NewGotoHeurist::Solution &dest) {
 void NewGotoHeurist::ces(NewGotoHeurist::Solution &sol) {
     for (int k = n1; k <= n2; ++k) {
         for (int device = 0; device < devices; ++device) {
+            if (deadline.poll()) { // sol and best stay valid, solve stops next
+                return;
+            }
             GFDR(sol, device);
             if (sol.twl < best.twl) {
                 copy(sol, best);
@@ -23,56 +23,40 @@ void write_sol(int n, const float *prior, const int* perm, NewHeuristQAP::ans_t
     to->cost = cost;
 }
 
-// random
-
-enum {
-    RANDOM_INT_LEFT = 0,
-    RANDOM_INT_RIGHT = 1000000000-1
-};
-
-std::default_random_engine random_gen{};
-std::uniform_real_distribution<> real_dist(0, 1);
-std::uniform_int_distribution<> int_dist(RANDOM_INT_LEFT, RANDOM_INT_RIGHT);
+// NewHeuristQAP
 
-void set_seed(uint32_t s) {
+void NewHeuristQAP::set_seed(uint32_t s) {
     random_gen.seed(s);
 }
 
-int rand_int(int l, int r) {
+int NewHeuristQAP::rand_int(int l, int r) {
     return l + int_dist(random_gen) % (r - l + 1);
 }
 
-float rand_real() {
+float NewHeuristQAP::rand_real() {
     return real_dist(random_gen);
 }
 
-// NewHeuristQAP
-
-NewHeuristQAP::NewHeuristQAP(const cost_t &cost) {
-    n = (int) cost.size();
-    n_2 = n * n;
-    n_3 = n * n * n;
-    C = new ans_t[n_3 * n];
+NewHeuristQAP::NewHeuristQAP(const cost_t &cost) : NewHeuristQAP([&cost] {
+    int n = (int) cost.size();
+    CostTensor tensor(n);
     for (int i = 0; i < n; ++i) {
         for (int j = 0; j < n; ++j) {
             for (int k = 0; k < n; ++k) {
-                for (int l = 0; l < n; ++l) {
-                    C[idx(i, j, k, l)] = cost[i][j][k][l];
-                    assert(cost[i][i][l][k] == 0);
-                    assert(cost[i][j][l][k] == cost[j][i][k][l]);
-                    if (cost[i][i][l][k] != 0) {
-                        return;
-                    }
-                }
+                std::copy(cost[i][j][k].begin(), cost[i][j][k].end(), tensor.row(i, j, k));
             }
         }
     }
-}
+    return QapCost(std::move(tensor));
+}()) {}
 
-NewHeuristQAP::~NewHeuristQAP() {
-    delete[] C;
+NewHeuristQAP::NewHeuristQAP(QapCost cost) : C{std::move(cost)} {
+    n = C.size();
+    n_2 = n * n;
 }
 
+NewHeuristQAP::~NewHeuristQAP() = default;
+
 std::vector<int> NewHeuristQAP::solve(int n1_new, int n2_new, int tabu_tenure_new, int S_new,
 						   int z_new, double max_time_new,
 						   int max_iters_new, int seed_new, bool verbose_new, int debug_t) {
@@ -97,6 +81,10 @@ std::vector<std::pair<double, std::vector<int>>> NewHeuristQAP::get_debug_info()
     return debug_info;
 }
 
+void NewHeuristQAP::set_cancel(const std::atomic<bool>* flag) {
+    cancel = flag;
+}
+
 void NewHeuristQAP::init_all(int n1_new, int n2_new, int tabu_tenure_new, int S_new,
 				  int z_new, double max_time_new, int max_iters_new, int seed_new, bool verbose_new, int debug_t) {
     n2_new = std::min(n2_new, n);
@@ -122,7 +110,7 @@ void NewHeuristQAP::init_all(int n1_new, int n2_new, int tabu_tenure_new, int S_
     if (max_time_new != -1) {
         assert(max_time_new > 0);
         assert(max_time_new < 1000);
-        max_time = static_cast<clock_t>(max_time_new * 1e6);
+        max_time = max_time_new;
         use_time = true;
     }
 
@@ -153,8 +141,10 @@ void NewHeuristQAP::free_all() {
 }
 
 bool NewHeuristQAP::need_stop(int iter) {
-    if (use_time) {
-        return clock() - start_clock > max_time;
+    if (deadline.expired()) { // time or cancel
+        return true;
+    } else if (use_time) {
+        return false;
     } else {
         assert(iter != -1);
         return iter > max_iters;
@@ -163,7 +153,7 @@ bool NewHeuristQAP::need_stop(int iter) {
 
 void NewHeuristQAP::work() {
     int iter = 0;
-    start_clock = clock();
+    deadline = Deadline(use_time ? max_time : -1, cancel);
 
     gen_M();
 
@@ -173,15 +163,15 @@ void NewHeuristQAP::work() {
     printf("top=%d, ", top);
     printf("n1,n2=(%d,%d), ", n1, n2);
     printf("seed=%d, ", seed);
-    printf("time=%.2g, ", (double) max_time / 1e6);
+    printf("time=%.2g, ", max_time);
     printf("debug_interval=%d\n", debug_interval);
 
-    clock_t last_t = clock();
+    long long last_t = deadline.elapsed_us();
 
     if (debug_interval != -1) {
         sort_M();
         upd_best();
-        debug_info.emplace_back((clock() - start_clock) / 1e6, std::vector<int>{best->perm, best->perm + n});
+        debug_info.emplace_back(deadline.elapsed(), std::vector<int>{best->perm, best->perm + n});
     }
 
     while (!need_stop(iter)) {
@@ -195,9 +185,9 @@ void NewHeuristQAP::work() {
         gark(rand_int(1, 100), 5); // maybe here heavy too
 
         if (debug_interval != -1) {
-            clock_t cur_t = clock();
-            if ((int)(cur_t - last_t) >= debug_interval) {
-                debug_info.emplace_back((cur_t - start_clock) / 1e6, std::vector<int>{best->perm, best->perm + n});
+            long long cur_t = deadline.elapsed_us();
+            if (cur_t - last_t >= debug_interval) {
+                debug_info.emplace_back(cur_t / 1e6, std::vector<int>{best->perm, best->perm + n});
                 last_t = cur_t;
             }
         }
@@ -209,7 +199,7 @@ void NewHeuristQAP::work() {
     upd_best();
 
     if (debug_interval != -1) {
-        debug_info.emplace_back((clock() - start_clock) / 1e6, std::vector<int>{best->perm, best->perm + n});
+        debug_info.emplace_back(deadline.elapsed(), std::vector<int>{best->perm, best->perm + n});
     }
 }
 
@@ -219,7 +209,7 @@ NewHeuristQAP::ans_t NewHeuristQAP::cost(const int *perm) {
     ans_t ret = 0;
     for (int i = 0; i < n; ++i) {
         for (int j = i + 1; j < n; ++j) {
-            ret += C[idx(i, j, perm[i], perm[j])]; 
+            ret += C(i, j, perm[i], perm[j]); 
         }
     }
     return ret;
@@ -230,11 +220,11 @@ NewHeuristQAP::ans_t NewHeuristQAP::exchange_delta(const int *perm,
     ans_t ret = 0;
     for (int i = 0; i < n; ++i) {
         if (i != r && i != s) {
-            ret += C[idx(r, i, perm[s], perm[i])] - C[idx(r, i, perm[r], perm[i])]
-                     + C[idx(s, i, perm[r], perm[i])] - C[idx(s, i, perm[s], perm[i])];
+            ret += C(r, i, perm[s], perm[i]) - C(r, i, perm[r], perm[i])
+                     + C(s, i, perm[r], perm[i]) - C(s, i, perm[s], perm[i]);
         }
     }
-    ret += C[idx(s, r, perm[r], perm[s])] - C[idx(s, r, perm[s], perm[r])];
+    ret += C(s, r, perm[r], perm[s]) - C(s, r, perm[s], perm[r]);
     return ret;
 }
 
@@ -257,6 +247,9 @@ void NewHeuristQAP::init_tabu() {
 void NewHeuristQAP::cets(Sol *sol) {
     for (int k = n1; k <= n2; ++k) {
         for (int r = 0; r < n; ++r) {
+            if (deadline.poll()) { // sol and best stay valid, work() stops next
+                return;
+            }
             for (int s = r + 1; s < n; ++s) {
                 ans_t d = exchange_delta(sol->perm, r, s);
                 if (d < 0) {
@@ -506,10 +499,6 @@ void NewHeuristQAP::get_perm(const float *prior, int *perm) {
     }
 }
 
-int NewHeuristQAP::idx(int i, int j, int k, int l) {
-    return i * n_3 + j * n_2 + k * n + l;
-}
-
 int NewHeuristQAP::idx(int i, int j) {
     return i * n + j;
 }
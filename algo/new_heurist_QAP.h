@@ -1,8 +1,12 @@
 #pragma once
 
+#include "deadline.h"
+#include "qap_cost.h"
+
+#include <atomic>
 #include <vector>
-#include <ctime>
 #include <cstdint>
+#include <random>
 
 struct Sol {
 	using ans_t = long long;
@@ -16,10 +20,6 @@ void print_sol(int n, const Sol* sol);
 
 void write_sol(int n, const float *prior, const int* perm, Sol::ans_t cost, Sol *to);
 
-void set_seed(uint32_t s);
-int rand_int(int l, int r);
-float rand_real();
-
 class NewHeuristQAP {
 
 public:
@@ -32,6 +32,8 @@ public:
 	using cost_t = vvvvl;
 
 	explicit NewHeuristQAP(const cost_t &cost);
+	// takes a CostTensor without copying it, or a GridCostOracle for large n
+	explicit NewHeuristQAP(QapCost cost);
 	~NewHeuristQAP();
 
 	std::vector<int> solve(int n1_new, int n2_new, int tabu_tenure_new, int S_new,
@@ -41,6 +43,9 @@ public:
 
 	[[nodiscard]] std::vector<std::pair<double, std::vector<int>>> get_debug_info() const;
 
+	// solve returns its best so far once cancel is raised, null for none
+	void set_cancel(const std::atomic<bool>* flag);
+
 private:
 	void init_all(int n1_new, int n2_new, int tabu_tenure_new, int S_new,
 				  int z_new, double max_time_new = -1, int max_iters_new = -1, 
@@ -105,23 +110,35 @@ private:
 	void rand_sol(Sol* s);
 	void rand_prior(float *prior);				  // generate rand prior of len n
 	void get_perm(const float *prior, int *perm); // get perm by prior O(n log n)
-	int idx(int i, int j, int k, int l);
 	int idx(int i, int j);
 	void free_util();
 	int *temp_perm; // some perm of [0...n-1] 
 	int *temp_perm_S; // some perm of [0...S-1]
 
-	int n, n_2, n_3; // n, n^2, n^3
-	ans_t *C;
+	int n, n_2; // n, n^2
+	QapCost C;
 
 	// stop condition
-	clock_t max_time{0};
+	double max_time{-1}; // seconds
 	int max_iters{-1};
 	bool use_time{false};
-	clock_t start_clock{0};
+	Deadline deadline;
+	const std::atomic<bool>* cancel{nullptr};
 
-	// random
+	// random, one generator per engine, so solves on other threads do not touch it and a seed
+	// repeats its run
 	uint32_t seed;
+	enum {
+		RANDOM_INT_LEFT = 0,
+		RANDOM_INT_RIGHT = 1000000000-1
+	};
+	std::default_random_engine random_gen{};
+	std::uniform_real_distribution<> real_dist{0, 1};
+	std::uniform_int_distribution<> int_dist{RANDOM_INT_LEFT, RANDOM_INT_RIGHT};
+
+	void set_seed(uint32_t s);
+	int rand_int(int l, int r); // in [l, r]
+	float rand_real(); // in [0, 1)
 
 	//verbose
 	bool verbose{false};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace parallel {
+
+    // threads <= 0 means all hardware threads
+    inline int resolve_threads(int threads) {
+        if (threads > 0) {
+            return threads;
+        }
+        return std::max(1, (int) std::thread::hardware_concurrency());
+    }
+
+    // Calls task(i) for every i in [0, count) on up to `threads` threads, the calling thread included.
+    // Indices are handed out in increasing order, so a slow task does not hold back the others.
+    // Every task runs; afterwards the exception of the lowest failed index, if any, is rethrown.
+    template<typename Task>
+    void for_each_index(int count, int threads, Task&& task) {
+        std::vector<std::exception_ptr> errors(std::max(count, 0));
+        std::atomic<int> next{0};
+        auto worker = [&] {
+            for (int i = next++; i < count; i = next++) {
+                try {
+                    task(i);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+
+        int workers = std::min(resolve_threads(threads), count);
+        std::vector<std::thread> pool;
+        for (int i = 1; i < workers; ++i) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : pool) {
+            thread.join();
+        }
+
+        for (auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // for_each_index on threads started once, for loops run so often and so short that starting
+    // threads for each of them would cost more than the loop. Calls must not overlap.
+    class Pool {
+    public:
+        explicit Pool(int threads) {
+            for (int i = 1; i < resolve_threads(threads); ++i) {
+                workers.emplace_back([this] { serve(); });
+            }
+        }
+
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+
+        ~Pool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& thread : workers) {
+                thread.join();
+            }
+        }
+
+        // threads of the pool, the calling one included
+        [[nodiscard]] int size() const {
+            return (int) workers.size() + 1;
+        }
+
+        // as parallel::for_each_index, without allocating
+        template<typename Task>
+        void for_each_index(int count, Task&& task) {
+            using Callable = std::remove_reference_t<Task>;
+            run(count, [](void* context, int i) { (*static_cast<Callable*>(context))(i); }, &task);
+        }
+
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        long long generation{0};
+        bool stopping{false};
+        int busy{0}; // workers still in the current loop
+
+        int count{0};
+        void (*call)(void*, int){nullptr};
+        void* context{nullptr};
+        std::atomic<int> next{0};
+        int error_index{0};
+        std::exception_ptr error;
+
+        void run(int loop_count, void (*loop_call)(void*, int), void* loop_context) {
+            if (loop_count <= 0) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                count = loop_count;
+                call = loop_call;
+                context = loop_context;
+                next = 0;
+                error_index = loop_count;
+                error = nullptr;
+                busy = (int) workers.size();
+                ++generation;
+            }
+            wake.notify_all();
+            drain();
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                done.wait(lock, [this] { return busy == 0; });
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        void drain() {
+            for (int i = next++; i < count; i = next++) {
+                try {
+                    call(context, i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (i < error_index) {
+                        error_index = i;
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        void serve() {
+            long long seen = 0;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [&] { return stopping || generation != seen; });
+                    if (stopping) {
+                        return;
+                    }
+                    seen = generation;
+                }
+                drain();
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (--busy == 0) {
+                        done.notify_one();
+                    }
+                }
+            }
+        }
+    };
+
+} // namespace parallel
@@ -0,0 +1,42 @@
+#include "qap_cost.h"
+
+#include <stdexcept>
+#include <utility>
+
+GridCostOracle::GridCostOracle(int rows, int cols, int step_x, int step_y, ConnectivityModel model_)
+        : n{rows * cols}, model{std::move(model_)} {
+
+    if (model.devices != n) {
+        throw std::runtime_error("Connectivity size mismatch");
+    }
+
+    loc_x.resize(n);
+    loc_y.resize(n);
+    for (int s = 0; s < n; ++s) {
+        loc_x[s] = step_x * (s % cols);
+        loc_y[s] = step_y * (s / cols);
+    }
+}
+
+QapCost::QapCost(CostTensor tensor_)
+        : n{tensor_.size()}, tensor{std::move(tensor_)}, C{tensor.data()},
+          stride_i{tensor.stride_i()}, stride_j{tensor.stride_j()}, stride_k{tensor.stride_k()} {}
+
+QapCost::QapCost(GridCostOracle oracle_) : n{oracle_.size()}, oracle{std::move(oracle_)} {}
+
+void QapCost::check_symmetric() const {
+    if (!implicit()) {
+        tensor.check_symmetric(); // a share holds an empty tensor
+    }
+}
+
+QapCost QapCost::share() const {
+    QapCost ret;
+    ret.n = n;
+    ret.C = C;
+    ret.stride_i = stride_i;
+    ret.stride_j = stride_j;
+    ret.stride_k = stride_k;
+    ret.oracle = oracle;
+    return ret;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "connectivity.h"
+#include "cost_tensor.h"
+
+#include <cstdlib>
+#include <vector>
+
+// QAP cost of devices on a rows x cols grid without the n^4 tensor, O(n + edges) memory.
+// Same model as the Goto engines: a device pair (i, j) costs w * |x_i - x_j| plus an x pin term,
+// left[i][j] when x_i < x_j, left[j][i] when x_i > x_j and same_x when equal; y likewise with up.
+// It equals the tensor while pin offsets along an axis differ by at most the grid step,
+// i.e. while a device fits into its slot.
+class GridCostOracle {
+public:
+    GridCostOracle() = default;
+    // location s is row s / cols, column s % cols; the terms of (j, i) must be those of (i, j)
+    // with left and up negated, as from ConnectivityModel::from_records
+    GridCostOracle(int rows, int cols, int step_x, int step_y, ConnectivityModel model);
+
+    [[nodiscard]] int size() const { return n; }
+
+    // cost between i and j if pos[i] = k, pos[j] = l
+    [[nodiscard]] long long operator()(int i, int j, int k, int l) const {
+        if (i == j || k == l) {
+            return 0;
+        }
+        int e = model.find(i, j);
+        if (e < 0) {
+            return 0;
+        }
+        const PairTerms& t = model.terms[e];
+        int xk = loc_x[k], xl = loc_x[l];
+        int yk = loc_y[k], yl = loc_y[l];
+        long long ret = t.mul_x * std::abs(xk - xl) + t.mul_y * std::abs(yk - yl);
+        ret += xk == xl ? t.same_x : (xk < xl ? t.left : -t.left);
+        ret += yk == yl ? t.same_y : (yk < yl ? -t.up : t.up);
+        return ret;
+    }
+
+private:
+    int n{0};
+    ConnectivityModel model;
+    std::vector<int> loc_x, loc_y;
+};
+
+// Cost source of the ZD and NewHeurist engines: an explicit tensor or the implicit grid oracle.
+class QapCost {
+public:
+    QapCost() = default;
+    QapCost(CostTensor tensor);
+    QapCost(GridCostOracle oracle);
+
+    [[nodiscard]] int size() const { return n; }
+    [[nodiscard]] bool implicit() const { return C == nullptr; }
+
+    [[nodiscard]] long long operator()(int i, int j, int k, int l) const {
+        if (C == nullptr) {
+            return oracle(i, j, k, l);
+        }
+        return C[i * stride_i + j * stride_j + k * stride_k + l];
+    }
+
+    // throws unless the cost is zero-diagonal and symmetric; free for the oracle, which is by construction
+    // and for a share, whose owner is checked instead
+    void check_symmetric() const;
+
+    // reads the tensor of this one, which must outlive it, or a copy of the oracle:
+    // one per engine when engines run side by side on the same cost
+    [[nodiscard]] QapCost share() const;
+
+private:
+    int n{0};
+    CostTensor tensor;
+    const long long* C{nullptr}; // tensor.data(), nullptr for the oracle
+    size_t stride_i{0}, stride_j{0}, stride_k{0}; // of the tensor, in either entry order
+    GridCostOracle oracle;
+};
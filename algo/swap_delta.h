@@ -0,0 +1,76 @@
+#pragma once
+
+#include "qap_cost.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+// Objective changes of all pairwise exchanges of one permutation, kept up to date across swaps
+// (E. Taillard, Robust taboo search for the quadratic assignment problem, 1991).
+// The matrix is n x n row-major, entry [r * n + s] with r < s is the change when p[r] and p[s] are swapped.
+// delta(r, s, p) is the engine's O(n) delta, it may add terms of r and s alone, as a linear cost does.
+// The cost must be symmetric, C(i, j, k, l) == C(j, i, l, k), as the ZD engines check.
+namespace swap_delta {
+
+    // every pair from scratch, O(n^3)
+    template<typename Delta>
+    void fill(int n, const int* p, long long* out, Delta&& delta) {
+        for (int r = 0; r + 1 < n; ++r) {
+            for (int s = r + 1; s < n; ++s) {
+                out[r * n + s] = delta(r, s, p);
+            }
+        }
+    }
+
+    // after p[r] and p[s] were swapped, p is the new permutation. A pair (u, v) apart from r and s only sees
+    // the terms of q = r and q = s change. Their change is moved(u, p[v]) - moved(u, p[u]) + moved(v, p[u])
+    // - moved(v, p[v]), so the n x n table moved, 4 n^2 lookups, makes each such pair O(1);
+    // the 2n pairs with r or s are recomputed, O(n) each. scratch holds n * n values.
+    template<typename Delta>
+    void update(const QapCost& C, int n, const int* p, int r, int s, long long* out, long long* scratch,
+                Delta&& delta) {
+        if (r > s) {
+            std::swap(r, s);
+        }
+        // old places of r and s are the new places of s and r
+        int new_r = p[r], new_s = p[s];
+        // moved[w * n + y]: how the cost of w at y against r and s changed. C(w, q, y, x) is read
+        // as C(q, w, x, y), contiguous in y in either tensor order, see CostTensor::Order
+        long long* moved = scratch;
+        for (int w = 0; w < n; ++w) {
+            if (w == r || w == s) {
+                continue;
+            }
+            long long* row = moved + (size_t) w * n;
+            for (int y = 0; y < n; ++y) {
+                row[y] = C(r, w, new_r, y) - C(r, w, new_s, y) + C(s, w, new_s, y) - C(s, w, new_r, y);
+            }
+        }
+        for (int u = 0; u + 1 < n; ++u) {
+            if (u == r || u == s) {
+                continue;
+            }
+            int pu = p[u];
+            const long long* mu = moved + (size_t) u * n;
+            long long* row = out + (size_t) u * n;
+            for (int v = u + 1; v < n; ++v) {
+                if (v == r || v == s) {
+                    continue;
+                }
+                int pv = p[v];
+                const long long* mv = moved + (size_t) v * n;
+                row[v] += mu[pv] - mu[pu] + mv[pu] - mv[pv];
+            }
+        }
+        for (int u = 0; u < n; ++u) {
+            if (u != r) {
+                out[std::min(u, r) * n + std::max(u, r)] = delta(std::min(u, r), std::max(u, r), p);
+            }
+            if (u != s && u != r) {
+                out[std::min(u, s) * n + std::max(u, s)] = delta(std::min(u, s), std::max(u, s), p);
+            }
+        }
+    }
+
+} // namespace swap_delta
@@ -0,0 +1,109 @@
+// Cost models through the on-disk cache against fresh builds: the miss that writes a file and the hit
+// that reads it give the tensor and the connectivity build_cost_tensor and build_connectivity give,
+// for every net model and tensor order; a connectivity file with a damaged payload is rebuilt.
+
+#include "test_fixtures.h"
+#include "../src/Connectivity.h"
+#include "../src/CostCache.h"
+#include "../src/GridCost.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+namespace testing {
+
+    bool same(const CostTensor& a, const CostTensor& b) {
+        return a.size() == b.size() && a.order() == b.order()
+               && std::memcmp(a.data(), b.data(), a.entries() * sizeof(long long)) == 0;
+    }
+
+    bool same(const ConnectivityModel& a, const ConnectivityModel& b) {
+        return a.devices == b.devices && a.start == b.start && a.neighbor == b.neighbor
+               && a.terms.size() == b.terms.size()
+               && std::memcmp(a.terms.data(), b.terms.data(), a.terms.size() * sizeof(PairTerms)) == 0;
+    }
+
+    std::vector<std::string> cache_files(const std::string& dir) {
+        std::vector<std::string> ret;
+        DIR* d = opendir(dir.c_str());
+        assert(d != nullptr);
+        while (dirent* entry = readdir(d)) {
+            if (entry->d_name[0] != '.') {
+                ret.push_back(dir + "/" + entry->d_name);
+            }
+        }
+        closedir(d);
+        return ret;
+    }
+
+    void remove_cache(const std::string& dir) {
+        for (const std::string& file : cache_files(dir)) {
+            unlink(file.c_str());
+        }
+        rmdir(dir.c_str());
+    }
+
+    void tensor(const std::string& dir, const LayoutView& layout, NetModel model, int rows, int cols,
+                CostTensor::Order order) {
+        CostTensor fresh = build_cost_tensor(layout, model, rows, cols, 70, 50, 1, order);
+        CostTensor miss = cached_cost_tensor(dir, layout, model, rows, cols, 70, 50, 1, order);
+        CostTensor hit = cached_cost_tensor(dir, layout, model, rows, cols, 70, 50, 1, order);
+        assert(same(fresh, miss));
+        assert(same(fresh, hit));
+    }
+
+    void connectivity(const std::string& dir, const LayoutView& layout, NetModel model) {
+        ConnectivityModel fresh = build_connectivity(layout, model);
+        assert(same(fresh, cached_connectivity(dir, layout, model)));
+        assert(same(fresh, cached_connectivity(dir, layout, model)));
+    }
+
+    // flips the last byte of every cached file, then the connectivity must come out as built
+    void damaged_connectivity(const std::string& dir, const LayoutView& layout, NetModel model) {
+        remove_cache(dir);
+        ConnectivityModel fresh = build_connectivity(layout, model);
+        assert(same(fresh, cached_connectivity(dir, layout, model)));
+        for (const std::string& file : cache_files(dir)) {
+            FILE* f = fopen(file.c_str(), "r+b");
+            assert(f != nullptr);
+            fseek(f, -1, SEEK_END);
+            int c = fgetc(f);
+            fseek(f, -1, SEEK_END);
+            fputc(c ^ 0x5a, f);
+            fclose(f);
+        }
+        assert(same(fresh, cached_connectivity(dir, layout, model)));
+        assert(same(fresh, cached_connectivity(dir, layout, model)));
+    }
+
+} // namespace testing
+
+int main() {
+    char dir_template[] = "/tmp/test_cost_cache_XXXXXX";
+    assert(mkdtemp(dir_template) != nullptr);
+    std::string dir = dir_template;
+
+    std::mt19937 rnd(17);
+    const int rows = 3, cols = 4;
+    LayoutArrays layout = testing::random_layout(rows * cols, 24, rnd);
+
+    for (NetModel model : {NetModel::clique, NetModel::star, NetModel::b2b}) {
+        for (CostTensor::Order order : {CostTensor::Order::ijkl, CostTensor::Order::ikjl}) {
+            testing::tensor(dir, layout, model, rows, cols, order);
+        }
+        testing::connectivity(dir, layout, model);
+        testing::damaged_connectivity(dir, layout, model);
+    }
+
+    testing::remove_cache(dir);
+    puts("test_cost_cache: ok");
+    return 0;
+}
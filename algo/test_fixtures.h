@@ -0,0 +1,103 @@
+#pragma once
+
+// Random instances of the algo/test_* programs, the same seed gives the same instance.
+
+#include "cost_tensor.h"
+#include "qap_cost.h"
+#include "../src/Layout.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace testing {
+
+    // symmetric zero-diagonal tensor with entries in [0, range), a small range makes equal objectives common
+    inline CostTensor random_tensor(int n, int range, std::mt19937& rnd) {
+        CostTensor ret(n);
+        for (int i = 0; i < n; ++i) {
+            for (int j = i + 1; j < n; ++j) {
+                for (int k = 0; k < n; ++k) {
+                    for (int l = 0; l < n; ++l) {
+                        if (k != l) {
+                            ret.row(i, j, k)[l] = ret.row(j, i, l)[k] = rnd() % range;
+                        }
+                    }
+                }
+            }
+        }
+        return ret;
+    }
+
+    // cost of device i at position j, in [0, range)
+    inline std::vector<std::vector<long long>> random_dp_cost(int n, int range, std::mt19937& rnd) {
+        std::vector<std::vector<long long>> ret(n, std::vector<long long>(n));
+        for (auto& row : ret) {
+            for (long long& x : row) {
+                x = rnd() % range;
+            }
+        }
+        return ret;
+    }
+
+    // quadratic cost of p plus dp_cost[i][p[i]] when there is one
+    inline long long qap_obv(const QapCost& cost, const std::vector<int>& p,
+                             const std::vector<std::vector<long long>>& dp_cost = {}) {
+        int n = (int) p.size();
+        long long ret = 0;
+        for (int i = 0; i + 1 < n; ++i) {
+            for (int j = i + 1; j < n; ++j) {
+                ret += cost(i, j, p[i], p[j]);
+            }
+        }
+        for (int i = 0; i < (int) dp_cost.size(); ++i) {
+            ret += dp_cost[i][p[i]];
+        }
+        return ret;
+    }
+
+    // p is a permutation of 0..n-1
+    inline bool is_permutation(const std::vector<int>& p, int n) {
+        std::vector<bool> seen(n, false);
+        for (int x : p) {
+            if (x < 0 || x >= n || seen[x]) {
+                return false;
+            }
+            seen[x] = true;
+        }
+        return (int) p.size() == n;
+    }
+
+    // devices with three pins each at centers in [0, 1000); nets of 1-6 pins with every 20th net
+    // a 20-60 pin one, a net may hold several pins of one device. Link ../src/Layout.cpp.
+    inline LayoutArrays random_layout(int devices, int net_count, std::mt19937& rnd) {
+        std::vector<int> sizes(net_count);
+        int net_pins = 0;
+        for (int i = 0; i < net_count; ++i) {
+            sizes[i] = i % 20 == 0 ? (int) (rnd() % 41) + 20 : (int) (rnd() % 6) + 1;
+            net_pins += sizes[i];
+        }
+        int pins = devices * 3;
+        LayoutArrays layout = allocate_layout_arrays(devices, pins, net_count, net_pins);
+        for (int i = 0; i < devices; ++i) {
+            layout.center_x[i] = (int) (rnd() % 1000);
+            layout.center_y[i] = (int) (rnd() % 1000);
+            layout.device_half_width[i] = 10;
+            layout.device_half_height[i] = 10;
+        }
+        for (int i = 0; i < pins; ++i) {
+            layout.pin_device[i] = i / 3;
+            layout.pin_x[i] = (int) (rnd() % 21) - 10;
+            layout.pin_y[i] = (int) (rnd() % 21) - 10;
+        }
+        layout.net_start[0] = 0;
+        for (int i = 0; i < net_count; ++i) {
+            for (int j = 0; j < sizes[i]; ++j) {
+                layout.net_pins[layout.net_start[i] + j] = (int) (rnd() % pins);
+            }
+            layout.net_start[i + 1] = layout.net_start[i] + sizes[i];
+        }
+        return layout;
+    }
+
+} // namespace testing
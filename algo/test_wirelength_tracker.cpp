@@ -0,0 +1,58 @@
+// WirelengthTracker against evaluate_metrics: after every random move or swap on a random layout
+// the tracked manhattan and half-perimeter wirelength equal the ones computed from scratch.
+
+#include "test_fixtures.h"
+#include "../src/Metrics.h"
+#include "../src/WirelengthTracker.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace testing {
+
+    // the tracker sums per net size class, evaluate_metrics per net
+    bool close(double a, double b) {
+        return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+    }
+
+    void check(const WirelengthTracker& tracker, const LayoutView& layout) {
+        MetricTotals totals = evaluate_metrics(layout, METRIC_MANHATTAN | METRIC_HALF_P);
+        assert(close(tracker.manhattan(), totals.manhattan));
+        assert(close(tracker.half_p(), totals.half_p));
+    }
+
+    void moves_and_swaps(int devices, int nets, int steps, uint32_t seed) {
+        std::mt19937 rnd(seed);
+        LayoutArrays layout = random_layout(devices, nets, rnd);
+        WirelengthTracker tracker(layout);
+        check(tracker, layout);
+
+        for (int step = 0; step < steps; ++step) {
+            int a = (int) (rnd() % devices);
+            if (rnd() % 2 == 0) {
+                tracker.move(a, {(int) (rnd() % 1000), (int) (rnd() % 1000)});
+            } else {
+                tracker.swap(a, (int) (rnd() % devices));
+            }
+            check(tracker, layout);
+        }
+
+        // centers changed behind the tracker's back
+        for (int i = 0; i < devices; ++i) {
+            layout.center_x[i] = (int) (rnd() % 1000);
+        }
+        tracker.reset();
+        check(tracker, layout);
+    }
+
+} // namespace testing
+
+int main() {
+    testing::moves_and_swaps(1, 4, 20, 1);
+    testing::moves_and_swaps(10, 30, 500, 2);
+    testing::moves_and_swaps(200, 400, 2000, 3);
+    puts("test_wirelength_tracker: ok");
+    return 0;
+}
@@ -0,0 +1,77 @@
+// A ZD solve stopped at any point returns a permutation: the cancel flag raised from another thread
+// while solve runs, before it starts, and time limits so short that they expire inside an iteration.
+
+#include "ZD_heurist_QAP1.h"
+#include "test_fixtures.h"
+#include "zd_heurist_2.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace testing {
+
+    // raises the flag after delay_us while the engine solves without a time limit
+    template<typename Engine>
+    void cancel_while_solving(Engine& engine, int n, int delay_us, int seed) {
+        std::atomic<bool> flag{false};
+        engine.set_cancel(&flag);
+        std::thread canceller([&flag, delay_us] {
+            std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+            flag = true;
+        });
+        std::vector<int> p = engine.solve(-1, seed);
+        canceller.join();
+        assert(is_permutation(p, n));
+        engine.set_cancel(nullptr);
+    }
+
+    void cancel_qap1(int n, int k, uint32_t seed) {
+        std::mt19937 rnd(seed);
+        QapCost cost(random_tensor(n, 100, rnd));
+        ZD_heurist_QAP1 engine(cost.share(), k);
+
+        for (int delay_us : {0, 100, 1000, 5000, 20000}) {
+            cancel_while_solving(engine, n, delay_us, (int) seed);
+        }
+
+        std::atomic<bool> raised{true};
+        engine.set_cancel(&raised);
+        assert(is_permutation(engine.solve(-1, 1), n));
+    }
+
+    void cancel_zd2(int n, int k, uint32_t seed) {
+        std::mt19937 rnd(seed);
+        QapCost cost(random_tensor(n, 100, rnd));
+        ZD_heurist_2 engine(n, k);
+        engine.set_cost(cost.share());
+        engine.set_dp_cost(random_dp_cost(n, 50, rnd));
+
+        for (int delay_us : {0, 1000, 10000}) {
+            cancel_while_solving(engine, n, delay_us, (int) seed);
+        }
+    }
+
+    // budgets of 1-20 us run out inside QAP_iter, also during the first fillDelta
+    void short_budgets(int n, int k, uint32_t seed) {
+        std::mt19937 rnd(seed);
+        QapCost cost(random_tensor(n, 100, rnd));
+        ZD_heurist_QAP1 engine(cost.share(), k);
+        for (int t = 0; t < 200; ++t) {
+            assert(is_permutation(engine.solve(t % 20 + 1, 5), n));
+        }
+    }
+
+} // namespace testing
+
+int main() {
+    testing::cancel_qap1(30, 8, 1);
+    testing::cancel_zd2(30, 8, 2);
+    testing::short_budgets(30, 4, 3);
+    puts("test_zd_cancel: ok");
+    return 0;
+}
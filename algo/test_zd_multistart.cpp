@@ -0,0 +1,69 @@
+// ZD restarts on several workers, as zdTaskSolver runs them, are deterministic for a fixed seed and worker
+// count: two runs give the same permutation, and it is the one a serial replay of every worker's restarts
+// picks, the least score with ties to the lower worker and then the earlier restart.
+
+#include "ZD_heurist_QAP1.h"
+#include "multistart.h"
+#include "test_fixtures.h"
+
+#include <cassert>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace testing {
+
+    multistart::Best run(const QapCost& cost, int k, int workers, int restarts, int seed) {
+        std::vector<std::unique_ptr<ZD_heurist_QAP1>> engines(workers);
+        return multistart::run(workers, seed, [&](int w, int restart_seed) {
+            if (engines[w] == nullptr) {
+                engines[w] = std::make_unique<ZD_heurist_QAP1>(cost.share(), k);
+            }
+            std::vector<int> p = engines[w]->solve(-1, restart_seed);
+            double s = (double) qap_obv(cost, p);
+            return std::make_pair(std::move(p), s);
+        }, [&](int, int done) {
+            return done < restarts;
+        });
+    }
+
+    multistart::Best replay(const QapCost& cost, int k, int workers, int restarts, int seed) {
+        multistart::Best best;
+        for (int w = 0; w < workers; ++w) {
+            ZD_heurist_QAP1 engine(cost.share(), k);
+            std::mt19937 rnd = multistart::worker_stream(seed, w);
+            for (int r = 0; r < restarts; ++r) {
+                std::vector<int> p = engine.solve(-1, (int) rnd());
+                double s = (double) qap_obv(cost, p);
+                if (s < best.score) {
+                    best = {p, s, w};
+                }
+            }
+        }
+        return best;
+    }
+
+    void deterministic(int n, int range, int k, int workers, int restarts, uint32_t seed) {
+        std::mt19937 rnd(seed);
+        QapCost cost(random_tensor(n, range, rnd));
+        int run_seed = (int) (rnd() % 1000000);
+
+        multistart::Best first = run(cost, k, workers, restarts, run_seed);
+        multistart::Best second = run(cost, k, workers, restarts, run_seed);
+        multistart::Best serial = replay(cost, k, workers, restarts, run_seed);
+
+        assert(!first.p.empty());
+        assert(first.p == second.p && first.score == second.score && first.worker == second.worker);
+        assert(first.p == serial.p && first.score == serial.score && first.worker == serial.worker);
+    }
+
+} // namespace testing
+
+int main() {
+    testing::deterministic(8, 3, 2, 4, 3, 1);
+    testing::deterministic(12, 100, 3, 4, 2, 2);
+    testing::deterministic(16, 5, 4, 3, 2, 3);
+    puts("test_zd_multistart: ok");
+    return 0;
+}
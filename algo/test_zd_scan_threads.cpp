@@ -0,0 +1,65 @@
+// The parallel scan of the ZD engines gives the serial result: for a fixed seed, solve on 1 and on 4 scan
+// threads returns the same permutation with the same objective. The instances are large enough for
+// newBfs and updLists to go to the pool, small ones check the serial fallback.
+
+#include "ZD_heurist_QAP1.h"
+#include "test_fixtures.h"
+#include "zd_heurist_2.h"
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace testing {
+
+    void qap1(int n, int k, uint32_t seed) {
+        std::mt19937 rnd(seed);
+        QapCost cost(random_tensor(n, 100, rnd));
+        int solve_seed = (int) (rnd() % 1000000);
+
+        ZD_heurist_QAP1 serial(cost.share(), k);
+        ZD_heurist_QAP1 threaded(cost.share(), k);
+        threaded.set_scan_threads(4);
+
+        std::vector<int> p1 = serial.solve(-1, solve_seed);
+        std::vector<int> p4 = threaded.solve(-1, solve_seed);
+        assert(p1 == p4);
+        assert(qap_obv(cost, p1) == qap_obv(cost, p4));
+
+        // and again on the same engines, whose arenas and pools are reused
+        assert(serial.solve(-1, solve_seed) == p1);
+        assert(threaded.solve(-1, solve_seed) == p1);
+    }
+
+    void zd2(int n, int k, uint32_t seed) {
+        std::mt19937 rnd(seed);
+        QapCost cost(random_tensor(n, 100, rnd));
+        auto dp_cost = random_dp_cost(n, 50, rnd);
+        int solve_seed = (int) (rnd() % 1000000);
+
+        ZD_heurist_2 serial(n, k);
+        serial.set_cost(cost.share());
+        serial.set_dp_cost(dp_cost);
+        ZD_heurist_2 threaded(n, k);
+        threaded.set_cost(cost.share());
+        threaded.set_dp_cost(dp_cost);
+        threaded.set_scan_threads(4);
+
+        std::vector<int> p1 = serial.solve(-1, solve_seed);
+        std::vector<int> p4 = threaded.solve(-1, solve_seed);
+        assert(p1 == p4);
+        assert(qap_obv(cost, p1, dp_cost) == qap_obv(cost, p4, dp_cost));
+    }
+
+} // namespace testing
+
+int main() {
+    testing::qap1(8, 2, 1);
+    testing::zd2(8, 2, 2);
+    // n (n - 1) / 2 * K above MIN_PARALLEL_PAIRS
+    testing::qap1(36, 28, 3);
+    testing::zd2(36, 28, 4);
+    puts("test_zd_scan_threads: ok");
+    return 0;
+}
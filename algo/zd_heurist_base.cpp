@@ -0,0 +1,869 @@
+#include "zd_heurist_base.h"
+#include "swap_delta.h"
+
+#include <random>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+// Solution
+
+ZD_heurist_base::Solution::Solution() : p{nullptr}, obv{-1}, size{0} {}
+
+ZD_heurist_base::Solution::Solution(int* perm, long long obvPerm, int n) : p{perm}, obv{obvPerm}, size{n} {}
+
+ZD_heurist_base::Solution::Solution(const ZD_heurist_base::Solution& other) {
+    p = new int[other.size];
+    memcpy(p, other.p, other.size << 2); // assert that sizeof(int) == 4
+    obv = other.obv;
+    size = other.size;
+    hash = other.hash;
+}
+
+ZD_heurist_base::Solution::Solution(ZD_heurist_base::Solution&& other) noexcept {
+    p = other.p;
+    other.p = nullptr;
+    obv = other.obv;
+    size = other.size;
+    hash = other.hash;
+}
+
+ZD_heurist_base::Solution& ZD_heurist_base::Solution::operator=(const ZD_heurist_base::Solution& other) {
+    if (&other == this) {
+        return *this;
+    }
+    if (p == nullptr && other.p != nullptr) {
+        p = new int[other.size];
+    }
+    if (other.p != nullptr) {
+        memcpy(p, other.p, other.size << 2);
+    }
+    obv = other.obv;
+    size = other.size;
+    hash = other.hash;
+    return *this;
+}
+
+ZD_heurist_base::Solution& ZD_heurist_base::Solution::operator=(ZD_heurist_base::Solution&& other) noexcept {
+    // size == other.size
+    delete[] p;
+    p = other.p;
+    other.p = nullptr;
+    obv = other.obv;
+    size = other.size;
+    hash = other.hash;
+    return *this;
+}
+
+ZD_heurist_base::Solution::~Solution() {
+    delete[] p;
+}
+
+void ZD_heurist_base::Solution::print() const {
+    for (int i = 0; i < size; ++i) {
+        // printf("%d ", p[i]);
+    }
+    // printf("\n");
+}
+
+// List
+
+ZD_heurist_base::List::List() : a{nullptr}, size{0}, worst{nullptr}, K{0}, heap{nullptr}, place{nullptr} {}
+
+ZD_heurist_base::List::List(int k) : size{0}, worst{nullptr}, K{k} {
+    a = new Solution*[K];
+    heap = new int[K];
+    place = new int[K];
+}
+
+ZD_heurist_base::List::List(const ZD_heurist_base::List& other) {
+    // puts("List(cost List& other)");
+    K = other.K;
+    a = new Solution*[K];
+    heap = new int[K];
+    place = new int[K];
+    size = other.size;
+    for (int i = 0; i < size; ++i) {
+        a[i] = new Solution(*other.a[i]);
+    }
+    std::copy(other.heap, other.heap + size, heap);
+    std::copy(other.place, other.place + size, place);
+    worst = a + (other.worst - other.a);
+}
+
+ZD_heurist_base::List::List(ZD_heurist_base::List&& other) noexcept {
+    K = other.K;
+    a = other.a;
+    worst = other.worst;
+    size = other.size;
+    heap = other.heap;
+    place = other.place;
+    other.a = nullptr;
+    other.worst = nullptr;
+    other.size = 0;
+    other.heap = nullptr;
+    other.place = nullptr;
+}
+
+ZD_heurist_base::List& ZD_heurist_base::List::operator=(const ZD_heurist_base::List& other) {
+    if (this == &other) {
+        return *this;
+    }
+    delete[] a;
+    delete[] heap;
+    delete[] place;
+    K = other.K;
+    a = new Solution*[K];
+    heap = new int[K];
+    place = new int[K];
+    size = other.size;
+    for (int i = 0; i < size; ++i) {
+        a[i] = new Solution(*other.a[i]);
+    }
+    std::copy(other.heap, other.heap + size, heap);
+    std::copy(other.place, other.place + size, place);
+    worst = a + (other.worst - other.a);
+    return *this;
+}
+
+ZD_heurist_base::List& ZD_heurist_base::List::operator=(ZD_heurist_base::List&& other) noexcept {
+    delete[] a;
+    delete[] heap;
+    delete[] place;
+    K = other.K;
+    a = other.a;
+    worst = other.worst;
+    size = other.size;
+    heap = other.heap;
+    place = other.place;
+    other.a = nullptr;
+    other.worst = nullptr;
+    other.size = 0;
+    other.heap = nullptr;
+    other.place = nullptr;
+    return *this;
+}
+
+ZD_heurist_base::List::~List() {
+    delete[] a;
+    delete[] heap;
+    delete[] place;
+}
+
+void ZD_heurist_base::List::add(ZD_heurist_base::Solution* s) {
+    a[size] = s;
+    put(size, size);
+    siftUp(size);
+    ++size;
+    worst = a + heap[0];
+}
+
+void ZD_heurist_base::List::replaceWorst(ZD_heurist_base::Solution* s) {
+    int slot = (int) (worst - a);
+    *worst = s;
+    siftUp(place[slot]);
+    siftDown(place[slot]);
+    // the replaced slot stays the worst while it ties the top
+    if (a[heap[0]]->obv > s->obv) {
+        worst = a + heap[0];
+    }
+}
+
+bool ZD_heurist_base::List::above(int i, int j) const {
+    return a[i]->obv > a[j]->obv || (a[i]->obv == a[j]->obv && i < j);
+}
+
+void ZD_heurist_base::List::put(int at, int slot) {
+    heap[at] = slot;
+    place[slot] = at;
+}
+
+void ZD_heurist_base::List::siftUp(int at) {
+    int slot = heap[at];
+    while (at > 0 && above(slot, heap[(at - 1) / 2])) {
+        put(at, heap[(at - 1) / 2]);
+        at = (at - 1) / 2;
+    }
+    put(at, slot);
+}
+
+void ZD_heurist_base::List::siftDown(int at) {
+    int slot = heap[at];
+    while (2 * at + 1 < size) {
+        int child = 2 * at + 1;
+        if (child + 1 < size && above(heap[child + 1], heap[child])) {
+            ++child;
+        }
+        if (!above(heap[child], slot)) {
+            break;
+        }
+        put(at, heap[child]);
+        at = child;
+    }
+    put(at, slot);
+}
+
+void ZD_heurist_base::List::clear() {
+    worst = nullptr;
+    size = 0;
+}
+
+// ZD_heurist_base
+
+// constructor
+ZD_heurist_base::ZD_heurist_base(int size, int maxListSize)
+        : n{size}, K{maxListSize}, d{0}, solutionFactory{n, 4 * K + 1},
+          lists{List(K), List(K), List(K)}, memory{K} {
+
+    // the deltas of list0, list1, list2, the center and bfs, made up front as the solution slots
+    for (int i = 0; i < 3 * K + 2; ++i) {
+        deltaOwn.emplace_back(new long long[(size_t) n * n]);
+        deltaPool.push_back(deltaOwn.back().get());
+    }
+    deltaScratch.resize((size_t) n * n);
+
+    std::mt19937_64 rnd(n);
+    zobrist.resize((size_t) n * n);
+    for (unsigned long long& key : zobrist) {
+        key = rnd();
+    }
+
+    resizeScan(1);
+}
+
+void ZD_heurist_base::set_scan_threads(int threads) {
+    if (parallel::resolve_threads(threads) <= 1) {
+        pool.reset();
+        resizeScan(1);
+        return;
+    }
+    pool = std::make_unique<parallel::Pool>(threads);
+    resizeScan(K * (n - 1));
+}
+
+void ZD_heurist_base::set_cancel(const std::atomic<bool>* flag) {
+    cancel = flag;
+}
+
+void ZD_heurist_base::resizeScan(int rows) {
+    rows = std::max(rows, 1);
+    scanEntries.assign((size_t) rows * n, ScanEntry{});
+    scanRows.assign(rows, ScanRow{});
+    for (int i = 0; i < rows; ++i) {
+        scanRows[i].entries = scanEntries.data() + (size_t) i * n;
+    }
+}
+
+ZD_heurist_base::~ZD_heurist_base() = default;
+
+std::vector<int> ZD_heurist_base::solve(int time, int seed, int debug_t, double start_t) {
+    return solve(Deadline(time == -1 ? -1 : time / 1e6, cancel), seed, debug_t, start_t);
+}
+
+std::vector<int> ZD_heurist_base::solve(const Deadline& until, int seed, int debug_t, double start_t) {
+
+    debug_interval = debug_t;
+
+    if (seed == -1) {
+        std::mt19937 rnd(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        seed = (int) rnd();
+    }
+
+    printf("zd_heurist: ");
+    printf("seed=%d, ", seed);
+    printf("k=%d, ", K);
+    printf("debug_interval=%d\n", debug_interval);
+
+    int* p = randPerm(seed);
+    Solution center = Solution(p, obv(p), n);
+    center.hash = hashP(p);
+    Solution bfs = center;
+    // new solutions of QAP_iter, copied into their own buffers
+    Solution bfs2 = center, bfs3 = center;
+    solutionFactory.reset();
+
+    // d follows the seed too, so a seed and a scan thread count give one run
+    std::seed_seq stream{(uint32_t) seed, 1u};
+    std::mt19937 rnd(stream);
+
+    deadline = until;
+    long long last = 0;
+
+    if (debug_interval != -1) {
+        debug_info.emplace_back(start_t + deadline.elapsed(), std::vector<int>{bfs.p, bfs.p + n});
+    }
+
+    int c = 0;
+
+    while (!deadline.expired()) {
+        d = n - (rnd() % 3 + 2); // n-4 <= d <= n-2
+
+        if (d <= 0) {
+            d = 1;
+        }
+
+        bfs2.obv = -1;
+        bfs3.obv = -1;
+        QAP_iter(center, bfs2, bfs3); // find new solutions and write it to bfs2 and bfs3
+
+        if (bfs.obv > bfs2.obv) { // found better solution
+            c = 0;
+            bfs = bfs2;
+        }
+
+        ++c;
+
+        if (debug_interval != -1) {
+            long long cur = deadline.elapsed_us();
+            if (cur - last >= debug_interval) {
+                debug_info.emplace_back(start_t + cur / 1e6, std::vector<int>{bfs.p, bfs.p + n});
+                last = cur;
+            }
+        }
+
+        // QAP_iter leaves at its first check of an expired deadline, memory may be empty then;
+        // bfs2 was set before that check, so bfs is the best so far
+        if (deadline.expired() || memory.size == 0) {
+            break;
+        }
+
+        if (c == 1 || c == 3) {
+            center = bestMemory(memory);
+        } else if (c == 2 || c == 4) {
+            std::swap(center, bfs3);
+        } else {
+            break;
+        }
+    }
+
+    if (debug_interval != -1) {
+        debug_info.back() = {start_t + deadline.elapsed(), std::vector<int>{bfs.p, bfs.p + n}};
+    }
+
+    dropList(memory);
+
+    return {bfs.p, bfs.p + n};
+}
+
+std::vector<std::pair<double, std::vector<int>>> ZD_heurist_base::get_debug_info() const {
+    return debug_info;
+}
+
+const ZD_heurist_base::Solution& ZD_heurist_base::bestMemory(const List& memory) const {
+    assert(memory.size >= 1);
+
+    int best = 0;
+
+    for (int i = 1; i < memory.size; ++i) {
+        if (memory.a[best]->obv > memory.a[i]->obv) {
+            best = i;
+        }
+    }
+
+    return *memory.a[best];
+}
+
+void ZD_heurist_base::QAP_iter(Solution& center, Solution& bfs, Solution& bfs2) {
+
+    // puts("QAP iter...");
+
+    int dp = 0; // distance between p and bfs
+
+    List& list0 = lists[0]; // best K permutations with dist = dp
+    List& list1 = lists[1]; // best K permutations with dist = dp+1
+    List& list2 = lists[2]; // best K permutations with dist = dp+2
+
+    dropList(memory);
+
+    fillDelta(center);
+    list0.add(&center);
+
+    bfs = center;
+
+    // printf("d: %d\n", d);
+
+    while (dp <= d) {
+
+        if (deadline.expired()) {
+            break;
+        }
+
+        long long prevObv = bfs.obv;
+
+        newBfs(list0, bfs, bfs2); // find new solutions
+        bfs.print();
+        bfs2.print();
+
+        if (prevObv != bfs.obv) {
+            dropList(list1);
+            dropList(list2);
+            dp = 0;
+        }
+
+        updLists(list0, list1, list2, dp, bfs); // update list1, list2 and find new solutions
+
+        // memory is only read for its permutations
+        releaseDeltas(list0);
+        dropList(memory);
+        std::swap(memory, list0);
+
+        if (list1.size == 0) {
+            std::swap(list0, list2);
+            ++dp;
+        } else {
+            std::swap(list0, list1);
+            std::swap(list1, list2);
+        }
+
+        ++dp;
+    }
+
+    dropList(list0);
+    dropList(list1);
+    dropList(list2);
+    releaseDelta(center);
+    releaseDelta(bfs);
+}
+
+bool ZD_heurist_base::inlist(List& x, Solution* s) {
+    // samePerm only confirms a hash match
+    for (int i = 0; i < x.size; ++i) {
+        if (x.a[i]->hash == s->hash && x.a[i]->obv == s->obv && samePerm(*x.a[i], *s)) {
+            return false;
+        }
+    }
+
+    if (x.size < K) {
+        x.add(s);
+        return true;
+    }
+
+    releaseDelta(**x.worst);
+    solutionFactory.release(*x.worst);
+    x.replaceWorst(s);
+
+    return true;
+}
+
+void ZD_heurist_base::updLists(List& list0, List& list1, List& list2, int dp, const Solution& bfs) {
+    // every swap that takes a solution of list0 away from bfs is a candidate, in scan order
+    auto summarise = [&](int row, ScanRow& out) {
+        const Solution& curSol = *list0.a[row / (n - 1)];
+        int j = row % (n - 1);
+        out.size = 0;
+        for (int k = j + 1; k < n; ++k) {
+            int deltaW = deltaDeltaP(curSol.p, bfs.p, j, k);
+            if (deltaW <= 0) {
+                continue;
+            }
+            out.entries[out.size++] = {curSol.delta[j * n + k] + curSol.obv, swapHash(curSol, j, k), k, deltaW};
+        }
+    };
+    auto merge = [&](int row, const ScanRow& out) {
+        const Solution* curSol = list0.a[row / (n - 1)];
+        int j = row % (n - 1);
+        for (int e = 0; e < out.size; ++e) {
+            const ScanEntry& entry = out.entries[e];
+            Solution* newSol = solutionFactory.create(curSol, j, entry.k, entry.obv, entry.hash);
+
+            bool owned = false;
+
+            if (entry.w == 1) {
+                owned = inlist(list1, newSol);
+            } else if (entry.w == 2) {
+                owned = inlist(list2, newSol);
+            } else {
+                assert(entry.w <= 2);
+            }
+
+            if (!owned) {
+                solutionFactory.release(newSol);
+            }
+        }
+        return true;
+    };
+    scan(list0.size * (n - 1), (long long) list0.size * n * (n - 1) / 2, summarise, merge);
+
+    // the kept new solutions, their parents in list0 still have their permutations and deltas
+    for (List* list : {&list1, &list2}) {
+        for (int i = 0; i < list->size; ++i) {
+            Solution& s = *list->a[i];
+            if (s.pending) {
+                memcpy(s.p, s.from->p, n << 2);
+                std::swap(s.p[s.r], s.p[s.s]);
+                s.pending = false;
+            }
+            if (s.from != nullptr) {
+                deriveDelta(s);
+            }
+        }
+    }
+}
+
+template<typename Scan, typename Merge>
+void ZD_heurist_base::scan(int rows, long long pairs, Scan&& summarise, Merge&& merge) {
+    if (pool == nullptr || pairs < MIN_PARALLEL_PAIRS) {
+        for (int row = 0; row < rows; ++row) {
+            summarise(row, scanRows[0]);
+            if (!merge(row, scanRows[0])) {
+                return;
+            }
+        }
+        return;
+    }
+    assert(rows <= (int) scanRows.size());
+    pool->for_each_index(rows, [&](int row) { summarise(row, scanRows[row]); });
+    for (int row = 0; row < rows; ++row) {
+        if (!merge(row, scanRows[row])) {
+            return;
+        }
+    }
+}
+
+void ZD_heurist_base::newBfs(List& list0, Solution& bfs, Solution& bfs2) {
+
+    // bfs inited, bfs may be not
+
+    while (true) {
+
+        if (deadline.expired()) {
+            break;
+        }
+
+        // list0 is bfs alone after an improvement, the scan goes on from each swap
+        int found = list0.size == 1 && list0.a[0] == &bfs ? descend(bfs, bfs2) : scanList0(list0, bfs, bfs2);
+
+        if (found) {
+            if (bfs.from != nullptr) {
+                deriveDelta(bfs);
+            }
+            for (int i = 0; i < list0.size; ++i) {
+                if (list0.a[i] != &bfs) {
+                    releaseDelta(*list0.a[i]);
+                    solutionFactory.release(list0.a[i]);
+                }
+            }
+            list0.clear();
+            list0.add(&bfs);
+        } else {
+            break;
+        }
+    }
+}
+
+int ZD_heurist_base::scanList0(List& list0, Solution& bfs, Solution& bfs2) {
+    // The serial scan takes each swap below bfs as the new bfs and the least of the others as bfs2.
+    // A row keeps its records, the swaps below all before them in the row, in order, and the least
+    // of the rest: records may still be above bfs when the row is merged, the rest never go below it
+    auto summarise = [&](int row, ScanRow& out) {
+        const Solution& curSol = *list0.a[row / (n - 1)];
+        int j = row % (n - 1);
+        const long long* delta = curSol.delta + j * n;
+        out.size = 0;
+        out.best.obv = -1;
+        for (int k = j + 1; k < n; ++k) {
+            long long obvW = delta[k] + curSol.obv;
+            if (out.size == 0 || obvW < out.entries[out.size - 1].obv) {
+                out.entries[out.size++] = {obvW, 0, k, 0};
+            } else if (out.best.obv == -1 || obvW < out.best.obv) {
+                out.best = {obvW, 0, k, 0};
+            }
+        }
+    };
+
+    long long bestObv = bfs.obv, secondObv = bfs2.obv;
+    int bestRow = -1, bestK = 0, secondRow = -1, secondK = 0;
+    auto merge = [&](int row, const ScanRow& out) {
+        ScanEntry second = out.best;
+        for (int e = 0; e < out.size; ++e) {
+            const ScanEntry& entry = out.entries[e];
+            if (entry.obv < bestObv) {
+                bestObv = entry.obv;
+                bestRow = row;
+                bestK = entry.k;
+            } else if (second.obv == -1 || entry.obv < second.obv || (entry.obv == second.obv && entry.k < second.k)) {
+                second = entry;
+            }
+        }
+        if (second.obv != -1 && (secondObv == -1 || second.obv < secondObv)) {
+            secondObv = second.obv;
+            secondRow = row;
+            secondK = second.k;
+        }
+        return true;
+    };
+    scan(list0.size * (n - 1), (long long) list0.size * n * (n - 1) / 2, summarise, merge);
+
+    if (secondRow != -1) {
+        bfs2 = *list0.a[secondRow / (n - 1)];
+        swapP(bfs2, secondRow % (n - 1), secondK);
+        bfs2.obv = secondObv;
+    }
+    if (bestRow == -1) {
+        return 0;
+    }
+    Solution* curSol = list0.a[bestRow / (n - 1)];
+    bfs = *curSol;
+    swapP(bfs, bestRow % (n - 1), bestK);
+    bfs.from = curSol;
+    bfs.r = bestRow % (n - 1);
+    bfs.s = bestK;
+    bfs.obv = bestObv;
+    return 1;
+}
+
+int ZD_heurist_base::descend(Solution& bfs, Solution& bfs2) {
+    // first improvement from bfs: each swap with a negative delta is made at once and the scan goes on
+    // from the next swap with the new deltas, the least of the others between two improvements is bfs2
+    int found = 0;
+    int j0 = 0, k0 = 1;
+    while (j0 + 1 < n) {
+        std::atomic<int> firstImproving{n};
+        auto summarise = [&](int row, ScanRow& out) {
+            int j = j0 + row;
+            out.improving = -1;
+            out.best.obv = -1;
+            if (row > firstImproving.load(std::memory_order_relaxed)) {
+                return; // past an improvement, never merged
+            }
+            const long long* delta = bfs.delta + j * n;
+            for (int k = row == 0 ? k0 : j + 1; k < n; ++k) {
+                if (delta[k] < 0) {
+                    out.improving = k;
+                    int seen = firstImproving.load(std::memory_order_relaxed);
+                    while (row < seen && !firstImproving.compare_exchange_weak(seen, row)) {
+                    }
+                    return;
+                }
+                long long obvW = delta[k] + bfs.obv;
+                if (out.best.obv == -1 || obvW < out.best.obv) {
+                    out.best = {obvW, 0, k, 0};
+                }
+            }
+        };
+
+        long long secondObv = bfs2.obv;
+        int secondJ = -1, secondK = 0, improvingJ = -1, improvingK = 0;
+        auto merge = [&](int row, const ScanRow& out) {
+            if (out.best.obv != -1 && (secondObv == -1 || out.best.obv < secondObv)) {
+                secondObv = out.best.obv;
+                secondJ = j0 + row;
+                secondK = out.best.k;
+            }
+            if (out.improving != -1) {
+                improvingJ = j0 + row;
+                improvingK = out.improving;
+                return false;
+            }
+            return true;
+        };
+        scan(n - 1 - j0, (long long) (n - 1 - j0) * (n - j0) / 2, summarise, merge);
+
+        if (secondJ != -1) {
+            bfs2 = bfs;
+            swapP(bfs2, secondJ, secondK);
+            bfs2.obv = secondObv;
+        }
+        if (improvingJ == -1) {
+            break;
+        }
+
+        long long obvW = bfs.delta[improvingJ * n + improvingK] + bfs.obv;
+        swapP(bfs, improvingJ, improvingK);
+        updateDelta(bfs, improvingJ, improvingK);
+        bfs.obv = obvW;
+        found = 1;
+
+        j0 = improvingJ;
+        k0 = improvingK + 1;
+        if (k0 == n) {
+            ++j0;
+            k0 = j0 + 1;
+        }
+    }
+    return found;
+}
+
+long long ZD_heurist_base::obv(const int* w) const {
+    long long ret = 0;
+    for (int i = 0; i + 1 < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            ret += C(i, j, w[i], w[j]);
+        }
+    }
+    return ret;
+}
+
+int* ZD_heurist_base::randPerm(int seed) const {
+    if (seed == -1) {
+        std::mt19937 rnd(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        seed = rnd();
+    }
+    std::mt19937 rnd(seed);
+    int* p = new int[n];
+    for (int i = 0; i < n; ++i) {
+        p[i] = i;
+    }
+    std::shuffle(p, p + n, rnd);
+    return p;
+}
+
+long long ZD_heurist_base::deltaObv(int r, int s, const int* w) const {
+    long long ret = 0;
+    for (int i = 0; i < n; ++i) {
+        if (i != r && i != s) {
+            ret += C(r, i, w[s], w[i]) - C(r, i, w[r], w[i])
+                     + C(s, i, w[r], w[i]) - C(s, i, w[s], w[i]);
+        }
+    }
+    ret += C(s, r, w[r], w[s]) - C(s, r, w[s], w[r]);
+    return ret;
+}
+
+long long* ZD_heurist_base::takeDelta() {
+    if (deltaPool.empty()) {
+        deltaOwn.emplace_back(new long long[(size_t) n * n]);
+        return deltaOwn.back().get();
+    }
+    long long* ret = deltaPool.back();
+    deltaPool.pop_back();
+    return ret;
+}
+
+void ZD_heurist_base::fillDelta(Solution& s) {
+    if (s.delta == nullptr) {
+        s.delta = takeDelta();
+    }
+    s.from = nullptr;
+    swap_delta::fill(n, s.p, s.delta, [this](int r, int t, const int* p) { return deltaObv(r, t, p); });
+}
+
+void ZD_heurist_base::deriveDelta(Solution& s) {
+    const Solution& from = *s.from;
+    s.from = nullptr;
+    if (s.delta == nullptr) {
+        s.delta = takeDelta();
+    }
+    std::copy(from.delta, from.delta + (size_t) n * n, s.delta);
+    updateDelta(s, s.r, s.s);
+}
+
+void ZD_heurist_base::updateDelta(Solution& s, int r, int t) {
+    swap_delta::update(C, n, s.p, r, t, s.delta, deltaScratch.data(),
+                       [this](int u, int v, const int* p) { return deltaObv(u, v, p); });
+}
+
+void ZD_heurist_base::releaseDelta(Solution& s) {
+    if (s.delta != nullptr) {
+        deltaPool.push_back(s.delta);
+        s.delta = nullptr;
+    }
+    s.from = nullptr;
+}
+
+void ZD_heurist_base::releaseDeltas(List& list) {
+    for (int i = 0; i < list.size; ++i) {
+        releaseDelta(*list.a[i]);
+    }
+}
+
+unsigned long long ZD_heurist_base::hashP(const int* p) const {
+    unsigned long long ret = 0;
+    for (int i = 0; i < n; ++i) {
+        ret ^= zobrist[i * n + p[i]];
+    }
+    return ret;
+}
+
+unsigned long long ZD_heurist_base::swapHash(const Solution& s, int j, int k) const {
+    return s.hash ^ zobrist[j * n + s.p[j]] ^ zobrist[k * n + s.p[k]] ^ zobrist[j * n + s.p[k]]
+           ^ zobrist[k * n + s.p[j]];
+}
+
+void ZD_heurist_base::swapP(Solution& s, int j, int k) const {
+    s.hash = swapHash(s, j, k);
+    std::swap(s.p[j], s.p[k]);
+}
+
+void ZD_heurist_base::dropList(List& list) {
+    for (int i = 0; i < list.size; ++i) {
+        releaseDelta(*list.a[i]);
+        solutionFactory.release(list.a[i]);
+    }
+    list.clear();
+}
+
+bool ZD_heurist_base::samePerm(const Solution& a, const Solution& b) const {
+    auto at = [](const Solution& s, int i) {
+        if (!s.pending) {
+            return s.p[i];
+        }
+        return s.from->p[i == s.r ? s.s : i == s.s ? s.r : i];
+    };
+    for (int i = 0; i < n; ++i) {
+        if (at(a, i) != at(b, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int ZD_heurist_base::deltaDeltaP(const int* w, const int* bfs, int j, int k) const {
+    int ret = 0;
+
+    if (w[j] == bfs[j]) {
+        ++ret;
+    } else if (w[k] == bfs[j]) {
+        --ret;
+    }
+
+    if (w[k] == bfs[k]) {
+        ++ret;
+    } else if (w[j] == bfs[k]) {
+        --ret;
+    }
+
+    return ret;
+}
+
+// SolutionFactory
+
+ZD_heurist_base::SolutionFactory::SolutionFactory(int size, int capacity) : n{size} {
+    slots.reserve(capacity);
+    for (int i = 0; i < capacity; ++i) {
+        slots.emplace_back(new int[n], -1, n);
+    }
+    freed.reserve(capacity);
+    reset();
+}
+
+ZD_heurist_base::Solution *ZD_heurist_base::SolutionFactory::create(const Solution* from, int r, int s, long long obv,
+                                                  unsigned long long hash) {
+    assert(!freed.empty());
+    Solution* ret = freed.back();
+    freed.pop_back();
+    ret->obv = obv;
+    ret->hash = hash;
+    ret->from = const_cast<Solution*>(from);
+    ret->r = r;
+    ret->s = s;
+    ret->pending = true;
+    return ret;
+}
+
+void ZD_heurist_base::SolutionFactory::release(Solution* s) {
+    if (s >= slots.data() && s < slots.data() + slots.size()) {
+        freed.push_back(s);
+    }
+}
+
+void ZD_heurist_base::SolutionFactory::reset() {
+    freed.clear();
+    for (Solution& s : slots) {
+        freed.push_back(&s);
+    }
+}
+
+
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "deadline.h"
+#include "parallel.h"
+#include "qap_cost.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// The Z. Drezner heuristic (A New Heuristic for the Quadratic Assignment Problem, Journal of Applied
+// Mathematics and Decision Sciences, 6(3), 2002, 143-153) over a symmetric QapCost. The engines differ
+// in their objective only: they set C and override obv and deltaObv when they add to the quadratic cost.
+class ZD_heurist_base {
+public:
+    // cost_t[i][j][k][l] is cost between i and j if pos[i] = k, pos[j] = l
+    using cost_t = std::vector<std::vector<std::vector<std::vector<long long>>>>;
+
+    /// @brief solves QAP problem using Z. Drezner heuristic
+    /// @brief Without a time limit, -1, a seed other than -1 gives the same permutation on every call.
+    /// @return permutation \param p where i-th facility assigned to p[i]-th position.
+    std::vector<int> solve(int time = -1, int seed = -1, int debug_t = -1, double start_t = 0);
+
+    /// @brief solve until the deadline, a copy of it, instead of for a time in us. Its cancel flag is checked
+    /// @brief in place of set_cancel's, debug times are start_t plus the time since the deadline was made.
+    std::vector<int> solve(const Deadline& until, int seed = -1, int debug_t = -1, double start_t = 0);
+
+    /// @brief scans the swaps of newBfs and updLists on threads, 0 means all hardware threads.
+    /// @brief The result is the one of the serial scan, 1 thread, the default.
+    void set_scan_threads(int threads);
+
+    /// @brief solve returns its best so far once cancel is raised, null for none.
+    void set_cancel(const std::atomic<bool>* flag);
+
+    std::vector<std::pair<double, std::vector<int>>> get_debug_info() const;
+
+    virtual ~ZD_heurist_base();
+
+protected:
+    // maxListSize is the maximum size of list0, list1, list2
+    ZD_heurist_base(int size, int maxListSize);
+
+    QapCost C;
+    int n;
+
+    // objective of w and its change when w[r] and w[s] are swapped, O(n^2) and O(n); the quadratic cost by default
+    [[nodiscard]] virtual long long obv(const int* w) const;
+    [[nodiscard]] virtual long long deltaObv(int r, int s, const int* w) const;
+
+private:
+    int K;
+    int d{};
+
+
+    struct Solution {
+        int* p;
+        long long obv;
+        int size;
+        unsigned long long hash{0}; // Zobrist hash of p, see hashP
+
+        // swap deltas of p (swap_delta.h) from the engine pool while the solution is scanned in list0;
+        // copies and moves leave it, the engine attaches and releases it
+        long long* delta{nullptr};
+        // made from this one by swapping r and s, its delta is derived after the scan that made it
+        Solution* from{nullptr};
+        int r{0};
+        int s{0};
+        // p is not written yet, it is from->p with r and s swapped: updLists only writes the kept ones
+        bool pending{false};
+
+        Solution();
+        Solution(int* perm, long long obvPerm, int n);
+        Solution(const Solution& other);
+        Solution(Solution&& other) noexcept;
+        Solution& operator=(const Solution& other);
+        Solution& operator=(Solution&& other) noexcept;
+        ~Solution();
+
+        void print() const;
+    };
+
+    // fixed arena of the solutions made in updLists: at most 4K + 1 of them are alive at a time,
+    // K in each of list0, list1, list2 and memory and the candidate being tried. All slots are allocated
+    // in the constructor, a solution goes back to the arena when it leaves the lists
+    struct SolutionFactory {
+
+        SolutionFactory(int size, int capacity);
+
+        SolutionFactory() = delete;
+        SolutionFactory(const SolutionFactory&) = delete;
+        SolutionFactory(SolutionFactory&&) = delete;
+        SolutionFactory& operator=(const SolutionFactory&) = delete;
+        SolutionFactory& operator=(SolutionFactory&&) = delete;
+        ~SolutionFactory() = default;
+
+        Solution* create(const Solution* from, int r, int s, long long obv, unsigned long long hash); // pending
+
+        void release(Solution* s); // solutions outside the arena, as the center and bfs, are left alone
+        void reset(); // every slot free
+
+        int n;
+
+        std::vector<Solution> slots;
+        std::vector<Solution*> freed;
+    } solutionFactory;
+
+    struct List {
+        Solution** a;
+        int size;
+        Solution** worst;
+        int K;
+
+        // slots of a as a binary heap, the greatest obv on top and ties to the lower slot, so the top is
+        // the first worst entry; place[i] is where slot i is in it
+        int* heap;
+        int* place;
+
+        void add(Solution* s);
+        void replaceWorst(Solution* s); // O(log K)
+        void clear();
+
+        [[nodiscard]] bool above(int i, int j) const;
+        void siftUp(int at);
+        void siftDown(int at);
+        void put(int at, int slot);
+
+        List();
+        explicit List(int k);
+        List(const List& other);
+        List(List&& other) noexcept;
+        List& operator=(const List& other);
+        List& operator=(List&& other) noexcept;
+        ~List();
+    };
+
+    // list0, list1 and list2 of QAP_iter and the memory it leaves, made once for their buffers;
+    // QAP_iter rotates them by swapping
+    List lists[3];
+    List memory;
+
+    // Zobrist keys of facility i at position k, [i * n + k]: a permutation hashes to the xor over i
+    // of its keys and a swap changes the hash by four of them
+    std::vector<unsigned long long> zobrist;
+
+    [[nodiscard]] unsigned long long hashP(const int* p) const;
+    [[nodiscard]] unsigned long long swapHash(const Solution& s, int j, int k) const; // of s with j and k swapped
+    void swapP(Solution& s, int j, int k) const; // swaps p[j] and p[k] of s with its hash, O(1)
+
+    // The scans go by rows, a row is a solution and j with all its swaps (j, k > j). Rows are summarised
+    // on their own, in the pool when there is one, then merged in scan order, so every thread count
+    // gives the serial result
+    struct ScanEntry {
+        long long obv;
+        unsigned long long hash;
+        int k;
+        int w; // deltaDeltaP of the swap, updLists
+    };
+
+    struct ScanRow {
+        ScanEntry* entries; // n of them
+        int size;
+        ScanEntry best; // newBfs: the least swap past the row records, obv -1 if none
+        int improving; // descend: first k with a negative delta, -1 if none
+    };
+
+    std::unique_ptr<parallel::Pool> pool;
+    std::vector<ScanRow> scanRows; // one without the pool, (n - 1) K with it
+    std::vector<ScanEntry> scanEntries;
+
+    static constexpr long long MIN_PARALLEL_PAIRS = 1 << 14; // smaller scans stay on the calling thread
+
+    template<typename Scan, typename Merge>
+    void scan(int rows, long long pairs, Scan&& summarise, Merge&& merge);
+    void resizeScan(int rows);
+    int scanList0(List& list0, Solution& bfs, Solution& bfs2);
+    int descend(Solution& bfs, Solution& bfs2);
+    [[nodiscard]] int* randPerm(int seed = -1) const;
+
+    // swap delta matrices: every solution in list0, list1 or list2, the center and bfs hold one
+    std::vector<std::unique_ptr<long long[]>> deltaOwn;
+    std::vector<long long*> deltaPool; // free ones
+    std::vector<long long> deltaScratch; // n x n table of swap_delta::update
+
+    long long* takeDelta();
+    void fillDelta(Solution& s); // from scratch, O(n^3)
+    void deriveDelta(Solution& s); // from s.from, O(n^2)
+    void updateDelta(Solution& s, int r, int t); // p[r] and p[t] of s were just swapped, O(n^2)
+    void releaseDelta(Solution& s);
+    void releaseDeltas(List& list);
+    void dropList(List& list); // its solutions leave the lists: deltas and slots go back, the list is cleared
+    [[nodiscard]] bool samePerm(const Solution& a, const Solution& b) const; // either may be pending
+    [[nodiscard]] int deltaDeltaP(const int* w, const int* bfs, int j, int k) const;
+
+    void newBfs(List& list0, Solution& bfs, Solution& bfs2);
+    void updLists(List& list0, List& list1, List& list2, int dp, const Solution& bfs);
+    bool inlist(List& x, Solution* s);
+    void QAP_iter(Solution& center, Solution& bfs, Solution& bfs2);
+
+    [[nodiscard]] const Solution& bestMemory(const List& memory) const;
+
+    //debug
+    int debug_interval{-1};
+    std::vector<std::pair<double, std::vector<int>>> debug_info{};
+
+    //time
+    Deadline deadline;
+    const std::atomic<bool>* cancel{nullptr};
+};
\ No newline at end of file
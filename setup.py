@@ -4,13 +4,15 @@ from distutils.core import setup, Extension
 ext_modules = [
     Extension(
         'placer',
-        ['src/module.cpp', 'src/impl.cpp', 'src/TaskSolver.cpp', 'src/IdleTaskSolver.cpp',
-         'src/bfTaskSolver.cpp', 'src/zdTaskSolver.cpp', 'algo/ZD_heurist_QAP1.cpp', 'src/LayoutGenerator.cpp',
+        ['src/module.cpp', 'src/impl.cpp', 'src/TaskSolver.cpp', 'src/Layout.cpp', 'src/LayoutIO.cpp', 'src/Metrics.cpp',
+         'src/IdleTaskSolver.cpp', 'src/bfTaskSolver.cpp', 'src/zdTaskSolver.cpp', 'algo/ZD_heurist_QAP1.cpp', 'algo/zd_heurist_base.cpp', 'algo/cost_tensor.cpp', 'algo/qap_cost.cpp', 'algo/connectivity.cpp', 'src/GridCost.cpp', 'src/LayoutGenerator.cpp',
          'src/newTaskSolver.cpp', 'src/dpTaskSolver.cpp', 'algo/dp.cpp', 'algo/new_heurist_QAP.cpp',
-         'algo/goto.cpp', 'algo/new_goto.cpp', 'src/newGotoSolver.cpp', 'src/gotoSolver.cpp'],
+         'algo/goto.cpp', 'algo/new_goto.cpp', 'src/newGotoSolver.cpp', 'src/gotoSolver.cpp', 'src/NetModel.cpp', 'src/Connectivity.cpp', 'src/CostCache.cpp', 'src/MemoryBudget.cpp',
+         'src/WirelengthTracker.cpp'],
         include_dirs=[pybind11.get_include()],
         language='c++',
-        extra_compile_args=['-std=c++20'],
+        extra_compile_args=['-std=c++20', '-pthread'],
+        extra_link_args=['-pthread'],
     ),
 ]
 
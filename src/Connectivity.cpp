@@ -0,0 +1,128 @@
+#include "Connectivity.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+
+    struct PinRecord {
+        int device;
+        int x;
+        int y;
+    };
+
+    struct DeviceGroup {
+        int device;
+        int begin;
+        int end;
+        long long sum_x;
+        long long sum_y;
+    };
+
+    // sum of |a - b| over a from a[0..n), b from b[0..m), both sorted
+    long long cross_abs_sum(const int* a, int n, const int* b, int m, long long sum_b) {
+        long long ret = 0;
+        long long below = 0; // sum of b[0..p)
+        int p = 0;
+        for (int i = 0; i < n; ++i) {
+            while (p < m && b[p] <= a[i]) {
+                below += b[p++];
+            }
+            ret += 1ll * a[i] * p - below + (sum_b - below) - 1ll * a[i] * (m - p);
+        }
+        return ret;
+    }
+
+    // every pin pair of a net weighs the same, pairs of two devices are summed per device group
+    void add_clique_records(const LayoutView& layout, std::vector<ConnectivityModel::Record>& records) {
+        std::vector<PinRecord> pins;
+        std::vector<DeviceGroup> groups;
+        std::vector<int> xs, ys;
+
+        for (int net = 0; net < layout.net_count; ++net) {
+            int size = layout.net_size(net);
+            if (size <= 1) {
+                continue;
+            }
+            long long coef = net_weight(1, size - 1);
+
+            pins.clear();
+            for (int i = layout.net_start[net]; i < layout.net_start[net + 1]; ++i) {
+                int p = layout.net_pins[i];
+                pins.push_back({layout.pin_device[p], layout.pin_x[p], layout.pin_y[p]});
+            }
+            std::sort(pins.begin(), pins.end(), [](const PinRecord& a, const PinRecord& b) {
+                return a.device < b.device;
+            });
+
+            groups.clear();
+            xs.resize(size);
+            ys.resize(size);
+            for (int i = 0; i < size; ++i) {
+                if (groups.empty() || groups.back().device != pins[i].device) {
+                    groups.push_back({pins[i].device, i, i, 0, 0});
+                }
+                DeviceGroup& g = groups.back();
+                g.end = i + 1;
+                g.sum_x += pins[i].x;
+                g.sum_y += pins[i].y;
+                xs[i] = pins[i].x;
+                ys[i] = pins[i].y;
+            }
+            for (const DeviceGroup& g : groups) {
+                std::sort(xs.begin() + g.begin, xs.begin() + g.end);
+                std::sort(ys.begin() + g.begin, ys.begin() + g.end);
+            }
+
+            for (int gi = 0; gi < (int) groups.size(); ++gi) {
+                const DeviceGroup& g = groups[gi];
+                long long cnt_g = g.end - g.begin;
+                for (int hi = gi + 1; hi < (int) groups.size(); ++hi) {
+                    const DeviceGroup& h = groups[hi];
+                    long long cnt_h = h.end - h.begin;
+                    // groups go in device order, so g.device < h.device
+                    long long mul = coef * cnt_g * cnt_h;
+                    long long left = coef * (cnt_g * h.sum_x - cnt_h * g.sum_x);
+                    long long up = coef * (cnt_h * g.sum_y - cnt_g * h.sum_y);
+                    long long same_x = coef * cross_abs_sum(xs.data() + g.begin, (int) cnt_g,
+                                                            xs.data() + h.begin, (int) cnt_h, h.sum_x);
+                    long long same_y = coef * cross_abs_sum(ys.data() + g.begin, (int) cnt_g,
+                                                            ys.data() + h.begin, (int) cnt_h, h.sum_y);
+                    records.push_back({g.device, h.device, {mul, left, same_x, mul, up, same_y}});
+                }
+            }
+        }
+    }
+
+    void add_pair_records(const LayoutView& layout, NetModel model,
+                          std::vector<ConnectivityModel::Record>& records) {
+        std::vector<PinPair> pairs;
+        for (int net = 0; net < layout.net_count; ++net) {
+            pairs.clear();
+            append_net_pin_pairs(layout, model, net, pairs);
+            for (PinPair p : pairs) {
+                int a = layout.pin_device[p.a];
+                int b = layout.pin_device[p.b];
+                if (a > b) {
+                    std::swap(a, b);
+                    std::swap(p.a, p.b);
+                }
+                int dx = layout.pin_x[p.b] - layout.pin_x[p.a];
+                int dy = layout.pin_y[p.a] - layout.pin_y[p.b];
+                records.push_back({a, b, {p.wx, p.wx * dx, p.wx * std::abs(dx), p.wy, p.wy * dy, p.wy * std::abs(dy)}});
+            }
+        }
+    }
+
+} // namespace
+
+ConnectivityModel build_connectivity(const LayoutView& layout, NetModel model) {
+    std::vector<ConnectivityModel::Record> records;
+    if (model == NetModel::clique) {
+        add_clique_records(layout, records);
+    } else {
+        add_pair_records(layout, model, records);
+    }
+    return ConnectivityModel::from_records(layout.device_count, std::move(records));
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Layout.h"
+#include "NetModel.h"
+#include "../algo/connectivity.h"
+
+// Connectivity of the layout devices under the net model, shared by the grid solvers; weights in
+// NET_WEIGHT_SCALE units. For the clique pins of a net are grouped by device first, so a device pair
+// costs O(pins of both devices) instead of O(their product); memory and time are O(pins + device pairs
+// sharing a net). Star and b2b go through their O(k) pin pairs per net.
+ConnectivityModel build_connectivity(const LayoutView& layout, NetModel model);
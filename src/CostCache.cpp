@@ -0,0 +1,234 @@
+#include "CostCache.h"
+#include "LayoutIO.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace cost_cache;
+
+namespace {
+
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+    void fnv(uint64_t& hash, const void* data, size_t size) {
+        auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+    }
+
+    void fnv_ints(uint64_t& hash, const int* data, int count) {
+        fnv(hash, data, (size_t) count * sizeof(int));
+    }
+
+    uint64_t align_up(uint64_t x) {
+        return (x + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    Header make_key(Kind kind, const LayoutView& layout, NetModel model, int rows, int cols, int step_x,
+                    int step_y, CostTensor::Order order = CostTensor::Order::ijkl) {
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.header_size = sizeof(Header);
+        header.kind = kind;
+        header.net_model = (int32_t) model;
+        header.layout_hash = layout_cost_hash(layout, model);
+        header.rows = rows;
+        header.cols = cols;
+        header.step_x = step_x;
+        header.step_y = step_y;
+        header.tensor_order = (int32_t) order;
+        header.devices = layout.device_count;
+        return header;
+    }
+
+    // the key fields of a header, everything before edges
+    bool same_key(const Header& a, const Header& b) {
+        return std::memcmp(&a, &b, offsetof(Header, edges)) == 0;
+    }
+
+    std::string cache_path(const std::string& cache_dir, const Header& key) {
+        uint64_t hash = FNV_OFFSET;
+        fnv(hash, &key, offsetof(Header, edges));
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.cost", (unsigned long long) hash);
+        return cache_dir + "/" + name;
+    }
+
+    // header of a cached file if it holds the model of key, whole and of the expected size
+    bool read_header(const std::string& path, const Header& key, Header& header) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        bool ret = fread(&header, sizeof(Header), 1, file) == 1;
+        struct stat st{};
+        ret = ret && fstat(fileno(file), &st) == 0 && (uint64_t) st.st_size == header.file_size;
+        fclose(file);
+        return ret && same_key(header, key);
+    }
+
+    // pieces written one after another at their offsets, zero padding between them
+    struct Piece {
+        uint64_t offset;
+        const void* data;
+        size_t size;
+    };
+
+    void write_pieces(const std::string& cache_dir, const std::string& path, const std::vector<Piece>& pieces) {
+        if (mkdir(cache_dir.c_str(), 0777) == -1 && errno != EEXIST) {
+            throw std::runtime_error("Cant create " + cache_dir);
+        }
+        std::string tmp = path + ".tmp" + std::to_string(getpid());
+        FILE* file = fopen(tmp.c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Cant open " + tmp);
+        }
+        bool ok = true;
+        uint64_t pos = 0;
+        static const char zeros[ALIGNMENT * 16]{};
+        for (const Piece& piece : pieces) {
+            while (ok && pos < piece.offset) {
+                size_t pad = std::min<uint64_t>(sizeof(zeros), piece.offset - pos);
+                ok = fwrite(zeros, 1, pad, file) == pad;
+                pos += pad;
+            }
+            ok = ok && fwrite(piece.data, 1, piece.size, file) == piece.size;
+            pos += piece.size;
+        }
+        if (fclose(file) != 0 || !ok || rename(tmp.c_str(), path.c_str()) != 0) {
+            unlink(tmp.c_str());
+            throw std::runtime_error("Cant write " + path);
+        }
+    }
+
+    template<typename T>
+    void copy_section(const MappedFile& file, uint64_t offset, std::vector<T>& out, size_t count) {
+        out.resize(count);
+        std::memcpy(out.data(), file.data() + offset, count * sizeof(T));
+    }
+
+    uint64_t connectivity_checksum(const ConnectivityModel& model) {
+        uint64_t hash = FNV_OFFSET;
+        fnv(hash, model.start.data(), model.start.size() * sizeof(int));
+        fnv(hash, model.neighbor.data(), model.neighbor.size() * sizeof(int));
+        fnv(hash, model.terms.data(), model.terms.size() * sizeof(PairTerms));
+        return hash;
+    }
+
+    // the CSR of a connectivity read back from a file, the engines index with it unchecked
+    bool valid_connectivity(const ConnectivityModel& model) {
+        const std::vector<int>& start = model.start;
+        if (start[0] != 0 || start[model.devices] != model.edges()) {
+            return false;
+        }
+        for (int a = 0; a < model.devices; ++a) {
+            if (start[a] > start[a + 1]) {
+                return false;
+            }
+        }
+        return std::all_of(model.neighbor.begin(), model.neighbor.end(),
+                           [&model](int b) { return 0 <= b && b < model.devices; });
+    }
+
+} // namespace
+
+uint64_t layout_cost_hash(const LayoutView& layout, NetModel model) {
+    uint64_t hash = FNV_OFFSET;
+    int counts[] = {layout.device_count, layout.pin_count, layout.net_count, layout.net_pin_count};
+    fnv(hash, counts, sizeof(counts));
+    fnv_ints(hash, layout.pin_device, layout.pin_count);
+    fnv_ints(hash, layout.pin_x, layout.pin_count);
+    fnv_ints(hash, layout.pin_y, layout.pin_count);
+    fnv_ints(hash, layout.net_start, layout.net_count + 1);
+    fnv_ints(hash, layout.net_pins, layout.net_pin_count);
+    if (model == NetModel::b2b) {
+        fnv_ints(hash, layout.center_x, layout.device_count);
+        fnv_ints(hash, layout.center_y, layout.device_count);
+    }
+    return hash;
+}
+
+CostTensor cached_cost_tensor(const std::string& cache_dir, const LayoutView& layout, NetModel model,
+                              int rows, int cols, int step_x, int step_y, int threads,
+                              CostTensor::Order order, bool huge_pages) {
+    if (cache_dir.empty() || layout.device_count == 0) {
+        return build_cost_tensor(layout, model, rows, cols, step_x, step_y, threads, order, huge_pages);
+    }
+    Header key = make_key(COST_TENSOR, layout, model, rows, cols, step_x, step_y, order);
+    std::string path = cache_path(cache_dir, key);
+
+    Header header{};
+    if (read_header(path, key, header)) {
+        return CostTensor::map_file(path, TENSOR_OFFSET, layout.device_count, order);
+    }
+
+    CostTensor cost = build_cost_tensor(layout, model, rows, cols, step_x, step_y, threads, order, huge_pages);
+    header = key;
+    header.file_size = TENSOR_OFFSET + cost.entries() * sizeof(long long);
+    write_pieces(cache_dir, path, {
+            {0, &header, sizeof(Header)},
+            {TENSOR_OFFSET, cost.data(), cost.entries() * sizeof(long long)}
+    });
+    return cost;
+}
+
+ConnectivityModel cached_connectivity(const std::string& cache_dir, const LayoutView& layout, NetModel model) {
+    if (cache_dir.empty()) {
+        return build_connectivity(layout, model);
+    }
+    Header key = make_key(CONNECTIVITY, layout, model, 0, 0, 0, 0);
+    std::string path = cache_path(cache_dir, key);
+
+    size_t n = layout.device_count;
+    auto offsets = [n](size_t edges) {
+        uint64_t start = align_up(sizeof(Header));
+        uint64_t neighbor = align_up(start + (n + 1) * sizeof(int));
+        uint64_t terms = align_up(neighbor + edges * sizeof(int));
+        return std::vector<uint64_t>{start, neighbor, terms, terms + edges * sizeof(PairTerms)};
+    };
+
+    Header header{};
+    if (read_header(path, key, header) && header.edges >= 0
+        && offsets(header.edges).back() == header.file_size) {
+        MappedFile file(path);
+        std::vector<uint64_t> at = offsets(header.edges);
+        ConnectivityModel ret;
+        ret.devices = layout.device_count;
+        copy_section(file, at[0], ret.start, n + 1);
+        copy_section(file, at[1], ret.neighbor, header.edges);
+        copy_section(file, at[2], ret.terms, header.edges);
+        if (connectivity_checksum(ret) == header.checksum && valid_connectivity(ret)) {
+            return ret;
+        }
+    }
+
+    ConnectivityModel ret = build_connectivity(layout, model);
+    std::vector<uint64_t> at = offsets(ret.edges());
+    header = key;
+    header.edges = ret.edges();
+    header.file_size = at.back();
+    header.checksum = connectivity_checksum(ret);
+    write_pieces(cache_dir, path, {
+            {0, &header, sizeof(Header)},
+            {at[0], ret.start.data(), ret.start.size() * sizeof(int)},
+            {at[1], ret.neighbor.data(), ret.neighbor.size() * sizeof(int)},
+            {at[2], ret.terms.data(), ret.terms.size() * sizeof(PairTerms)}
+    });
+    return ret;
+}
+
+GridCostOracle cached_cost_oracle(const std::string& cache_dir, const LayoutView& layout, NetModel model,
+                                  int rows, int cols, int step_x, int step_y) {
+    return {rows, cols, step_x, step_y, cached_connectivity(cache_dir, layout, model)};
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Connectivity.h"
+#include "GridCost.h"
+#include "Layout.h"
+#include "NetModel.h"
+
+#include <cstdint>
+#include <string>
+
+// On-disk cache of the cost models the grid solvers build, shared between calls and processes.
+// A model is stored in <cache_dir>/<key>.cost, the key hashes the layout contents the model depends on
+// together with the grid parameters and the net model. Files are written to a temporary name and renamed,
+// so concurrent solvers never see a partial one; a file that does not match its key is rebuilt, as is
+// a connectivity whose payload fails its checksum or whose arrays do not index each other.
+// An empty cache_dir disables the cache, the functions then only build.
+namespace cost_cache {
+
+    constexpr char MAGIC[8] = {'P', 'L', 'C', 'C', 'O', 'S', 'T', 'M'};
+    constexpr uint32_t VERSION = 3;
+    constexpr uint64_t ALIGNMENT = 64;
+    // tensor entries start here, page aligned for page sizes up to 64K so the tensor is mapped in place
+    constexpr uint64_t TENSOR_OFFSET = 1 << 16;
+
+    enum Kind : uint32_t {
+        COST_TENSOR,
+        CONNECTIVITY // start, neighbor and terms arrays of ConnectivityModel at 64-byte aligned offsets
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+
+        uint32_t kind;
+        int32_t net_model;
+        uint64_t layout_hash;
+        int32_t rows; // grid parameters are zero for the connectivity, which does not depend on them
+        int32_t cols;
+        int32_t step_x;
+        int32_t step_y;
+        int32_t tensor_order; // CostTensor::Order of the stored tensor, zero for the connectivity
+
+        int32_t devices;
+        int32_t edges;
+        int32_t unused;
+        uint64_t file_size;
+        // FNV-1a of the connectivity arrays, zero for the tensor: it is mapped in place, not read
+        uint64_t checksum;
+    };
+
+} // namespace cost_cache
+
+// FNV-1a of the layout contents cost models depend on: pin devices and offsets and the nets,
+// device centers only for b2b, whose pin pairs come from the input placement
+uint64_t layout_cost_hash(const LayoutView& layout, NetModel model);
+
+// build_cost_tensor through the cache, the cached tensor is mapped from its file. Tensors of each order
+// are cached apart; huge_pages only applies to a built tensor, a mapped file has small pages.
+CostTensor cached_cost_tensor(const std::string& cache_dir, const LayoutView& layout, NetModel model,
+                              int rows, int cols, int step_x, int step_y, int threads = 1,
+                              CostTensor::Order order = CostTensor::Order::ijkl, bool huge_pages = false);
+
+// build_connectivity through the cache
+ConnectivityModel cached_connectivity(const std::string& cache_dir, const LayoutView& layout, NetModel model);
+
+// build_cost_oracle with the connectivity through the cache
+GridCostOracle cached_cost_oracle(const std::string& cache_dir, const LayoutView& layout, NetModel model,
+                                  int rows, int cols, int step_x, int step_y);
@@ -0,0 +1,115 @@
+#include "GridCost.h"
+#include "Connectivity.h"
+#include "../algo/parallel.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+CostTensor build_cost_tensor(const LayoutView& layout, NetModel model, int rows, int cols, int step_x, int step_y,
+                             int threads, CostTensor::Order order, bool huge_pages) {
+    int n = layout.device_count;
+    if (rows * cols != n) {
+        throw std::runtime_error("Dev cnt not Loc cnt");
+    }
+    CostTensor cost(n, order, huge_pages);
+
+    std::vector<PinPair> pairs;
+    for (int net = 0; net < layout.net_count; ++net) {
+        append_net_pin_pairs(layout, model, net, pairs);
+    }
+
+    // device -> its half of every pin pair: the other device, pin offset difference and weights
+    struct HalfPair {
+        int other;
+        int dx; // own pin x - other pin x
+        int dy;
+        long long wx;
+        long long wy;
+    };
+    std::vector<int> half_start(n + 1, 0);
+    for (const PinPair& p : pairs) {
+        ++half_start[layout.pin_device[p.a] + 1];
+        ++half_start[layout.pin_device[p.b] + 1];
+    }
+    for (int device = 0; device < n; ++device) {
+        half_start[device + 1] += half_start[device];
+    }
+    std::vector<HalfPair> halves(half_start[n]);
+    std::vector<int> pos(half_start.begin(), half_start.end() - 1);
+    for (const PinPair& p : pairs) {
+        int a = layout.pin_device[p.a];
+        int b = layout.pin_device[p.b];
+        int dx = layout.pin_x[p.a] - layout.pin_x[p.b];
+        int dy = layout.pin_y[p.a] - layout.pin_y[p.b];
+        halves[pos[a]++] = {b, dx, dy, p.wx, p.wy};
+        halves[pos[b]++] = {a, -dx, -dy, p.wx, p.wy};
+    }
+
+    // Location k is row k / cols, column k % cols. For devices (a, b) on locations (k, l) the x part of
+    // the cost depends only on dc = col_k - col_l: fx[b][dc] = sum of wx * |dc * step_x + x_a - x_b|
+    // over their pin pairs, y likewise with dr. Each task owns the entries [a][*][*][*] of one device a.
+    int span_x = 2 * cols - 1;
+    int span_y = 2 * rows - 1;
+    parallel::for_each_index(n, threads, [&](int a) {
+        std::vector<long long> fx((size_t) n * span_x, 0);
+        std::vector<long long> fy((size_t) n * span_y, 0);
+        std::vector<char> linked(n, 0);
+
+        for (int q = half_start[a]; q < half_start[a + 1]; ++q) {
+            const HalfPair& h = halves[q];
+            linked[h.other] = 1;
+            if (h.wx != 0) {
+                long long* bx = fx.data() + (size_t) h.other * span_x;
+                for (int t = 0; t < span_x; ++t) {
+                    bx[t] += h.wx * std::abs((t - cols + 1) * step_x + h.dx);
+                }
+            }
+            if (h.wy != 0) {
+                long long* by = fy.data() + (size_t) h.other * span_y;
+                for (int t = 0; t < span_y; ++t) {
+                    by[t] += h.wy * std::abs((t - rows + 1) * step_y + h.dy);
+                }
+            }
+        }
+
+        for (int b = 0; b < n; ++b) {
+            if (!linked[b]) {
+                continue; // the block stays zero
+            }
+            const long long* bx = fx.data() + (size_t) b * span_x;
+            const long long* by = fy.data() + (size_t) b * span_y;
+            for (int k = 0; k < n; ++k) {
+                long long* row = cost.row(a, b, k);
+                // l = rl * cols + cl, col_k - cl + cols - 1 indexes fx
+                const long long* fx_k = bx + (k % cols) + cols - 1;
+                const long long* fy_k = by + (k / cols) + rows - 1;
+                for (int rl = 0; rl < rows; ++rl) {
+                    long long y = fy_k[-rl];
+                    long long* out = row + (size_t) rl * cols;
+                    for (int cl = 0; cl < cols; ++cl) {
+                        out[cl] = y + fx_k[-cl];
+                    }
+                }
+                row[k] = 0;
+            }
+        }
+    });
+
+    return cost;
+}
+
+CostTensor::Order parse_tensor_order(const std::string& name) {
+    if (name == "ijkl") {
+        return CostTensor::Order::ijkl;
+    }
+    if (name == "ikjl") {
+        return CostTensor::Order::ikjl;
+    }
+    throw std::runtime_error("Unknown tensor order " + name + ", expected ijkl or ikjl");
+}
+
+GridCostOracle build_cost_oracle(const LayoutView& layout, NetModel model, int rows, int cols, int step_x,
+                                 int step_y) {
+    return {rows, cols, step_x, step_y, build_connectivity(layout, model)};
+}
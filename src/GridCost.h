@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Layout.h"
+#include "NetModel.h"
+#include "../algo/qap_cost.h"
+
+// QAP costs of the ZD and NewHeurist solvers: devices go to grid locations, a pin pair the net model
+// makes of a net costs its weights times the distance of the pins along x and y.
+
+// explicit n^4 tensor over the rows x cols grid, exact for any pin offsets; location k is row k / cols,
+// column k % cols. Costs of a device pair depend only on the row and column difference of the locations,
+// so each block is filled from per-pair tables in O(n^2) after O(pin pairs * (rows + cols)) to build them.
+// Pin pairs are kept for the build, O(k^2) per net for the clique and O(k) for star and b2b.
+// Device pairs are spread over threads, threads <= 0 means all hardware threads.
+// order and huge_pages go to the CostTensor constructor.
+CostTensor build_cost_tensor(const LayoutView& layout, NetModel model, int rows, int cols, int step_x, int step_y,
+                             int threads = 1, CostTensor::Order order = CostTensor::Order::ijkl,
+                             bool huge_pages = false);
+
+// "ijkl" or "ikjl", see CostTensor::Order
+CostTensor::Order parse_tensor_order(const std::string& name);
+
+// implicit oracle over the rows x cols grid, O(n + device pairs sharing a net) memory,
+// see GridCostOracle for when it is exact
+GridCostOracle build_cost_oracle(const LayoutView& layout, NetModel model, int rows, int cols, int step_x,
+                                 int step_y);
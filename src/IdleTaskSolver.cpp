@@ -6,7 +6,11 @@
 #include "IdleTaskSolver.h"
 
 Params IdleTaskSolver::get_params() {
-    return {};
+    return {
+        {placement_only_name, std::to_string(DEFAULT_PLACEMENT_ONLY), true},
+        {metrics_name, DEFAULT_METRICS, true},
+        {threads_name, std::to_string(DEFAULT_THREADS), true}
+    };
 }
 
 Params IdleTaskSolver::estimate() {
@@ -17,18 +21,15 @@ Params IdleTaskSolver::estimate() {
 
 Params IdleTaskSolver::solve() {
     auto start = clock();
-    write_layout(output_layout_path);
+    write_output();
     double cpu_time = static_cast<double>(clock() - start) / 1e6;
-    return {
+    Params params{
         {CPU_time, my_round(cpu_time, 3) + " sec", false},
-        {TWL_manhattan, my_round(calc_metric(calc_manhattan)), false},
-        {TWL_HP, my_round(calc_metric(calc_half_p)), false},
-        {TWL_clique, my_round(calc_metric(calc_clique)), false},
-        {TWL_hybrid, my_round(calc_metric(calc_hybrid)), false},
     };
+    add_metrics(params);
+    return params;
 }
 
 void IdleTaskSolver::init(const py::str &input_path, const py::str &output_path, const py::kwargs &kwargs) {
-    init_layout(input_path.cast<std::string>());
-    output_layout_path = output_path.cast<std::string>();
+    init_common(input_path, output_path, kwargs);
 }
@@ -0,0 +1,151 @@
+#include "Layout.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+void destroy_layout(Layout& layout) {
+    delete[] layout.devices;
+    delete[] layout.pins;
+    delete[] layout.nets;
+}
+
+Point Pin::absolute() const {
+    return {relative.x + assigned_device->center.x,
+            relative.y + assigned_device->center.y};
+}
+
+LayoutArrays::LayoutArrays(const LayoutView& view, std::shared_ptr<void> arena)
+: LayoutView{view}, arena{std::move(arena)} {}
+
+LayoutArrays::LayoutArrays(LayoutArrays&& other) noexcept
+: LayoutView{other}, arena{std::move(other.arena)} {
+    static_cast<LayoutView&>(other) = LayoutView{};
+}
+
+LayoutArrays& LayoutArrays::operator=(LayoutArrays&& other) noexcept {
+    if (this != &other) {
+        static_cast<LayoutView&>(*this) = other;
+        arena = std::move(other.arena);
+        static_cast<LayoutView&>(other) = LayoutView{};
+    }
+    return *this;
+}
+
+LayoutArrays allocate_layout_arrays(int device_count, int pin_count, int net_count, int net_pin_count) {
+    const size_t ALIGNMENT = 64;
+    auto aligned = [ALIGNMENT](size_t ints) {
+        return (ints * sizeof(int) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    };
+    size_t device_bytes = aligned(device_count);
+    size_t pin_bytes = aligned(pin_count);
+    size_t total = 4 * device_bytes + 5 * pin_bytes + aligned((size_t) net_count + 1) + aligned(net_pin_count);
+
+    void* memory = std::aligned_alloc(ALIGNMENT, std::max(total, ALIGNMENT));
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    std::shared_ptr<void> arena(memory, std::free);
+
+    char* pos = static_cast<char*>(memory);
+    auto take = [&pos](size_t bytes) {
+        int* ret = reinterpret_cast<int*>(pos);
+        pos += bytes;
+        return ret;
+    };
+
+    LayoutView view;
+    view.device_count = device_count;
+    view.pin_count = pin_count;
+    view.net_count = net_count;
+    view.net_pin_count = net_pin_count;
+    view.center_x = take(device_bytes);
+    view.center_y = take(device_bytes);
+    view.device_half_width = take(device_bytes);
+    view.device_half_height = take(device_bytes);
+    view.pin_device = take(pin_bytes);
+    view.pin_x = take(pin_bytes);
+    view.pin_y = take(pin_bytes);
+    view.pin_half_width = take(pin_bytes);
+    view.pin_half_height = take(pin_bytes);
+    view.net_start = take(aligned((size_t) net_count + 1));
+    view.net_pins = take(aligned(net_pin_count));
+    return {view, std::move(arena)};
+}
+
+LayoutArrays to_layout_arrays(const Layout& layout) {
+    int net_pin_count = 0;
+    for (int i = 0; i < layout.net_cnt; ++i) {
+        net_pin_count += (int) layout.nets[i].pins.size();
+    }
+    LayoutArrays arrays = allocate_layout_arrays(layout.device_cnt, layout.pin_cnt, layout.net_cnt, net_pin_count);
+    arrays.bbox_width = layout.bbox_width;
+    arrays.bbox_height = layout.bbox_height;
+
+    for (int i = 0; i < layout.device_cnt; ++i) {
+        const Device& d = layout.devices[i];
+        arrays.center_x[d.id] = d.center.x;
+        arrays.center_y[d.id] = d.center.y;
+        arrays.device_half_width[d.id] = d.half_width;
+        arrays.device_half_height[d.id] = d.half_height;
+    }
+
+    for (int i = 0; i < layout.pin_cnt; ++i) {
+        const Pin& p = layout.pins[i];
+        arrays.pin_device[p.id] = p.assigned_device->id;
+        arrays.pin_x[p.id] = p.relative.x;
+        arrays.pin_y[p.id] = p.relative.y;
+        arrays.pin_half_width[p.id] = p.half_width;
+        arrays.pin_half_height[p.id] = p.half_height;
+    }
+
+    // nets go in id order, so sizes are gathered first
+    std::vector<const Net*> by_id(layout.net_cnt);
+    for (int i = 0; i < layout.net_cnt; ++i) {
+        by_id[layout.nets[i].id] = layout.nets + i;
+    }
+    arrays.net_start[0] = 0;
+    for (int i = 0; i < layout.net_cnt; ++i) {
+        int pos = arrays.net_start[i];
+        for (const Pin* p : by_id[i]->pins) {
+            arrays.net_pins[pos++] = p->id;
+        }
+        arrays.net_start[i + 1] = pos;
+    }
+
+    return arrays;
+}
+
+Layout to_layout(const LayoutView& arrays) {
+    Layout layout{
+        new Device[arrays.device_count], new Pin[arrays.pin_count], new Net[arrays.net_count],
+        arrays.device_count, arrays.pin_count, arrays.net_count,
+        arrays.bbox_width, arrays.bbox_height
+    };
+
+    for (int i = 0; i < arrays.device_count; ++i) {
+        layout.devices[i].id = i;
+        layout.devices[i].center = arrays.center(i);
+        layout.devices[i].half_width = arrays.device_half_width[i];
+        layout.devices[i].half_height = arrays.device_half_height[i];
+    }
+
+    for (int i = 0; i < arrays.pin_count; ++i) {
+        layout.pins[i].id = i;
+        layout.pins[i].assigned_device = layout.devices + arrays.pin_device[i];
+        layout.pins[i].relative = {arrays.pin_x[i], arrays.pin_y[i]};
+        layout.pins[i].half_width = arrays.pin_half_width[i];
+        layout.pins[i].half_height = arrays.pin_half_height[i];
+    }
+
+    for (int i = 0; i < arrays.net_count; ++i) {
+        layout.nets[i].id = i;
+        layout.nets[i].pins.reserve(arrays.net_size(i));
+        for (int j = arrays.net_start[i]; j < arrays.net_start[i + 1]; ++j) {
+            layout.nets[i].pins.push_back(layout.pins + arrays.net_pins[j]);
+        }
+    }
+
+    return layout;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+struct Point {
+    int x, y;
+};
+
+struct Pin;
+
+struct Device {
+    int id;
+    int half_width;
+    int half_height;
+    Point center;
+    std::vector<Pin*> pins;
+};
+
+struct Pin {
+    int id;
+    int half_width;
+    int half_height;
+    Device* assigned_device;
+    Point relative;
+
+    [[nodiscard]] Point absolute() const;
+};
+
+struct Net {
+    int id;
+    std::vector<Pin*> pins;
+};
+
+struct Layout {
+    Device* devices{nullptr};
+    Pin* pins{nullptr};
+    Net* nets{nullptr};
+
+    int device_cnt{0};
+    int pin_cnt{0};
+    int net_cnt{0};
+
+    int bbox_width{0};
+    int bbox_height{0};
+};
+
+void destroy_layout(Layout& layout);
+
+// Struct-of-arrays layout, used by solvers and metrics. Ids are array indices,
+// pin coordinates are relative to the center of pin_device[pin],
+// pins of net i are net_pins[net_start[i]...net_start[i + 1]-1].
+// The view does not own the arrays.
+struct LayoutView {
+    int device_count{0};
+    int pin_count{0};
+    int net_count{0};
+    int net_pin_count{0};
+
+    int bbox_width{0};
+    int bbox_height{0};
+
+    int* center_x{nullptr};
+    int* center_y{nullptr};
+    int* device_half_width{nullptr};
+    int* device_half_height{nullptr};
+
+    int* pin_device{nullptr};
+    int* pin_x{nullptr};
+    int* pin_y{nullptr};
+    int* pin_half_width{nullptr};
+    int* pin_half_height{nullptr};
+
+    int* net_start{nullptr}; // net_count + 1 entries
+    int* net_pins{nullptr};
+
+    [[nodiscard]] int net_size(int net) const {
+        return net_start[net + 1] - net_start[net];
+    }
+
+    [[nodiscard]] int pin_abs_x(int pin) const {
+        return center_x[pin_device[pin]] + pin_x[pin];
+    }
+
+    [[nodiscard]] int pin_abs_y(int pin) const {
+        return center_y[pin_device[pin]] + pin_y[pin];
+    }
+
+    [[nodiscard]] Point center(int device) const {
+        return {center_x[device], center_y[device]};
+    }
+
+    void set_center(int device, Point p) const {
+        center_x[device] = p.x;
+        center_y[device] = p.y;
+    }
+};
+
+// Layout arrays together with their memory: one arena, every array at 64-byte aligned offset.
+// The arena is a heap block or a private mapping of a binary layout file.
+class LayoutArrays : public LayoutView {
+public:
+    LayoutArrays() = default;
+    LayoutArrays(const LayoutView& view, std::shared_ptr<void> arena);
+
+    LayoutArrays(const LayoutArrays&) = delete;
+    LayoutArrays& operator=(const LayoutArrays&) = delete;
+    LayoutArrays(LayoutArrays&& other) noexcept;
+    LayoutArrays& operator=(LayoutArrays&& other) noexcept;
+
+private:
+    std::shared_ptr<void> arena;
+};
+
+// heap arena for the given counts, array contents are uninitialized
+LayoutArrays allocate_layout_arrays(int device_count, int pin_count, int net_count, int net_pin_count);
+
+LayoutArrays to_layout_arrays(const Layout& layout);
+// pointer-linked copy, released by destroy_layout
+Layout to_layout(const LayoutView& layout);
@@ -0,0 +1,780 @@
+#include "LayoutIO.h"
+
+#include "../algo/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// MappedFile
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("Cant open " + path);
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Cant map " + path);
+    }
+    len = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        len = 0;
+        throw std::runtime_error("Cant map " + path);
+    }
+    ptr = static_cast<char*>(p);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : ptr{other.ptr}, len{other.len} {
+    other.ptr = nullptr;
+    other.len = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        if (ptr) {
+            munmap(ptr, len);
+        }
+        ptr = other.ptr;
+        len = other.len;
+        other.ptr = nullptr;
+        other.len = 0;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    if (ptr) {
+        munmap(ptr, len);
+    }
+}
+
+// text format
+
+namespace {
+
+    // files smaller than this are parsed in the calling thread
+    constexpr size_t PARALLEL_PARSE_MIN_BYTES = 1 << 20;
+    constexpr unsigned MAX_PARSE_THREADS = 8;
+
+    constexpr int PIN_FIELDS = 6; // id, device, x, y, half width, half height
+
+    // flags of ids met in a section, shared by threads parsing parts of one section
+    using SeenIds = std::vector<std::atomic<char>>;
+
+    bool is_space(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    bool is_digit(char c) {
+        return static_cast<unsigned char>(c - '0') < 10;
+    }
+
+    bool is_alpha(char c) {
+        return static_cast<unsigned char>((c | 0x20) - 'a') < 26;
+    }
+
+    // whitespace separated tokens of [cur, end), file_begin is used only for error positions
+    class TextScanner {
+    public:
+        TextScanner(const char* file_begin, const char* cur, const char* end, const std::string& path)
+        : file_begin{file_begin}, cur{cur}, end{end}, path{path} {}
+
+        bool at_end() {
+            skip_spaces();
+            return cur == end;
+        }
+
+        [[nodiscard]] const char* position() const {
+            return cur;
+        }
+
+        void seek(const char* to) {
+            cur = to;
+        }
+
+        // scanner over [from, to) of the same file
+        [[nodiscard]] TextScanner range(const char* from, const char* to) const {
+            return {file_begin, from, to, path};
+        }
+
+        void skip_word(const char* what) {
+            skip_spaces();
+            if (cur == end || !is_alpha(*cur)) {
+                fail(std::string("expected ") + what + " header");
+            }
+            while (cur != end && !is_space(*cur)) {
+                ++cur;
+            }
+        }
+
+        int next_int(const char* what) {
+            const char* p = cur;
+            while (p != end && is_space(*p)) {
+                ++p;
+            }
+            bool negative = false;
+            if (p != end && (*p == '-' || *p == '+')) {
+                negative = *p == '-';
+                ++p;
+            }
+            const char* digits_begin = p;
+            uint64_t value = 0;
+            if (end - p >= 8) {
+                // swar: up to 8 leading digits of the word are decoded without per-digit branches
+                uint64_t word;
+                memcpy(&word, p, 8);
+                // a carry out of a non-digit byte only spoils bytes after it
+                uint64_t non_digit = ((word & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull)
+                        | (((word + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull);
+                int len = non_digit ? __builtin_ctzll(non_digit) / 8 : 8;
+                if (len > 0) {
+                    // digits go to the high bytes, the low bytes become leading zeros
+                    uint64_t digits = (word - 0x3030303030303030ull) << (8 * (8 - len));
+                    digits = (digits * 10 + (digits >> 8)) & 0x00FF00FF00FF00FFull;
+                    digits = (digits * 100 + (digits >> 16)) & 0x0000FFFF0000FFFFull;
+                    value = (digits * 10000 + (digits >> 32)) & 0xFFFFFFFFull;
+                    p += len;
+                }
+            }
+            while (p != end && is_digit(*p)) {
+                value = value * 10 + (*p - '0');
+                ++p;
+            }
+            cur = p;
+            if (p == digits_begin || (p != end && !is_space(*p))) {
+                fail_expected(what);
+            }
+            // 18 digits cant overflow uint64_t
+            if (p - digits_begin > 18 || value > (uint64_t) INT32_MAX + negative) {
+                fail_overflow(what);
+            }
+            return negative ? static_cast<int>(-static_cast<int64_t>(value)) : static_cast<int>(value);
+        }
+
+        // id in [0, count) which was not seen before
+        int next_id(const char* what, int count, SeenIds& seen) {
+            int id = next_int(what);
+            if (id < 0 || id >= count) {
+                fail(std::string(what) + " " + std::to_string(id) + " is out of range [0, " + std::to_string(count) + ")");
+            }
+            if (seen[id].exchange(1, std::memory_order_relaxed)) {
+                fail(std::string("duplicate ") + what + " " + std::to_string(id));
+            }
+            return id;
+        }
+
+        void skip_token() {
+            skip_spaces();
+            while (cur != end && !is_space(*cur)) {
+                ++cur;
+            }
+        }
+
+        // every counted item takes at least two bytes, larger counts cant be satisfied by the file
+        int next_count(const char* what) {
+            int count = next_int(what);
+            if (count < 0) {
+                fail(std::string("negative ") + what);
+            }
+            if ((size_t) count > (size_t) (end - cur) / 2 + 1) {
+                fail(std::string(what) + " " + std::to_string(count) + " exceeds the file");
+            }
+            return count;
+        }
+
+        int next_ref(const char* what, int count) {
+            int id = next_int(what);
+            if (id < 0 || id >= count) {
+                fail(std::string(what) + " " + std::to_string(id) + " is out of range [0, " + std::to_string(count) + ")");
+            }
+            return id;
+        }
+
+        // start of the next section header, everything before it is numeric.
+        // Letters are the only expected bytes with 0x40 bit set, so the search goes by 8 bytes.
+        [[nodiscard]] const char* find_header() const {
+            const char* p = cur;
+            while (end - p >= 8) {
+                uint64_t word;
+                memcpy(&word, p, 8);
+                if (word & 0x4040404040404040ull) {
+                    break;
+                }
+                p += 8;
+            }
+            while (p != end && !is_alpha(*p)) {
+                ++p;
+            }
+            return p;
+        }
+
+        // kept out of line so that next_int stays small
+        [[noreturn]] __attribute__((noinline, cold)) void fail_expected(const char* what) const {
+            fail(std::string("expected ") + what);
+        }
+
+        [[noreturn]] __attribute__((noinline, cold)) void fail_overflow(const char* what) const {
+            fail(std::string(what) + " does not fit in int");
+        }
+
+        [[noreturn]] void fail(const std::string& message) const {
+            int line = 1 + (int) std::count(file_begin, cur, '\n');
+            throw std::runtime_error("Malformed layout " + path + ", line " + std::to_string(line) + ": " + message);
+        }
+
+    private:
+        void skip_spaces() {
+            while (cur != end && is_space(*cur)) {
+                ++cur;
+            }
+        }
+
+        const char* file_begin;
+        const char* cur;
+        const char* end;
+        const std::string& path;
+    };
+
+    // runs every task but the first one on its own thread, rethrows the first error in task order
+    void run_tasks(const std::vector<std::function<void()>>& tasks) {
+        parallel::for_each_index((int) tasks.size(), (int) tasks.size(), [&tasks](int i) {
+            tasks[i]();
+        });
+    }
+
+    void parse_devices(TextScanner scanner, const LayoutView& layout) {
+        SeenIds seen(layout.device_count);
+        for (int i = 0; i < layout.device_count; ++i) {
+            int id = scanner.next_id("device id", layout.device_count, seen);
+            layout.center_x[id] = scanner.next_int("device x");
+            layout.center_y[id] = scanner.next_int("device y");
+            layout.device_half_width[id] = scanner.next_int("device half width");
+            layout.device_half_height[id] = scanner.next_int("device half height");
+        }
+        if (!scanner.at_end()) {
+            scanner.fail("unexpected data after devices");
+        }
+    }
+
+    void parse_pins(TextScanner& scanner, int records, const LayoutView& layout, SeenIds& seen) {
+        for (int i = 0; i < records; ++i) {
+            int id = scanner.next_id("pin id", layout.pin_count, seen);
+            layout.pin_device[id] = scanner.next_ref("pin device", layout.device_count);
+            layout.pin_x[id] = scanner.next_int("pin x");
+            layout.pin_y[id] = scanner.next_int("pin y");
+            layout.pin_half_width[id] = scanner.next_int("pin half width");
+            layout.pin_half_height[id] = scanner.next_int("pin half height");
+        }
+    }
+
+    // tokens starting in [begin, end), begin must follow whitespace
+    size_t count_tokens(const char* begin, const char* end) {
+        size_t count = 0;
+        bool after_space = true;
+        for (const char* p = begin; p != end; ++p) {
+            bool space = is_space(*p);
+            count += after_space && !space;
+            after_space = space;
+        }
+        return count;
+    }
+
+    // Pins section split into chunks at whitespace. Chunk token counts give the index of the first
+    // record starting in every chunk, so chunks are parsed independently with exact error positions.
+    // Returns false without adding tasks if the token count does not match pin count.
+    bool add_pin_chunk_tasks(std::vector<std::function<void()>>& tasks, const TextScanner& scanner,
+                             const char* pins_begin, const char* pins_end, int chunks,
+                             const LayoutView& layout, SeenIds& seen) {
+        std::vector<const char*> bounds(chunks + 1, pins_end);
+        bounds[0] = pins_begin;
+        for (int k = 1; k < chunks; ++k) {
+            const char* p = std::max(bounds[k - 1], pins_begin + (pins_end - pins_begin) / chunks * k);
+            while (p != pins_end && !is_space(*p)) {
+                ++p;
+            }
+            bounds[k] = p;
+        }
+
+        std::vector<size_t> first_token(chunks + 1, 0);
+        std::vector<std::function<void()>> counting;
+        for (int k = 0; k < chunks; ++k) {
+            counting.emplace_back([&, k] { first_token[k + 1] = count_tokens(bounds[k], bounds[k + 1]); });
+        }
+        run_tasks(counting);
+        for (int k = 0; k < chunks; ++k) {
+            first_token[k + 1] += first_token[k];
+        }
+        if (first_token[chunks] != (size_t) PIN_FIELDS * layout.pin_count) {
+            return false;
+        }
+
+        for (int k = 0; k < chunks; ++k) {
+            size_t first_record = (first_token[k] + PIN_FIELDS - 1) / PIN_FIELDS;
+            size_t next_record = (first_token[k + 1] + PIN_FIELDS - 1) / PIN_FIELDS;
+            size_t skip = first_record * PIN_FIELDS - first_token[k];
+            const char* chunk_begin = bounds[k];
+            tasks.emplace_back([=, &scanner, &seen] {
+                TextScanner part = scanner.range(chunk_begin, pins_end);
+                for (size_t i = 0; i < skip; ++i) {
+                    part.skip_token();
+                }
+                parse_pins(part, (int) (next_record - first_record), layout, seen);
+            });
+        }
+        return true;
+    }
+
+    // Nets are the last section, optional bbox follows them. Net pins are read in file order
+    // into net_pins which has room for net_pin_capacity entries, then put in id order if needed.
+    void parse_nets(TextScanner scanner, LayoutView& layout, int net_pin_capacity) {
+        int net_count = layout.net_count;
+        SeenIds seen(net_count);
+        std::vector<int> file_start(net_count);
+        std::vector<int> sizes(net_count);
+        bool in_order = true;
+        int pos = 0;
+        for (int i = 0; i < net_count; ++i) {
+            int id = scanner.next_id("net id", net_count, seen);
+            in_order = in_order && id == i;
+            int net_size = scanner.next_count("net size");
+            if (net_size > net_pin_capacity - pos) {
+                scanner.fail("net size " + std::to_string(net_size) + " exceeds the file");
+            }
+            file_start[id] = pos;
+            sizes[id] = net_size;
+            for (int j = 0; j < net_size; ++j) {
+                layout.net_pins[pos++] = scanner.next_ref("net pin", layout.pin_count);
+            }
+        }
+        layout.net_pin_count = pos;
+
+        layout.net_start[0] = 0;
+        for (int i = 0; i < net_count; ++i) {
+            layout.net_start[i + 1] = layout.net_start[i] + sizes[i];
+        }
+        if (!in_order) {
+            std::vector<int> file_pins(layout.net_pins, layout.net_pins + pos);
+            for (int i = 0; i < net_count; ++i) {
+                std::copy_n(file_pins.begin() + file_start[i], sizes[i], layout.net_pins + layout.net_start[i]);
+            }
+        }
+
+        layout.bbox_width = 0;
+        layout.bbox_height = 0;
+        if (!scanner.at_end()) {
+            layout.bbox_width = scanner.next_int("bbox width");
+            layout.bbox_height = scanner.next_int("bbox height");
+            if (!scanner.at_end()) {
+                scanner.fail("unexpected data after bbox");
+            }
+        }
+    }
+
+    LayoutArrays parse_text_layout(const std::string& path) {
+        MappedFile file(path);
+        const char* begin = file.data();
+        const char* end = begin + file.size();
+
+        // headers and counts are read serially, then the sections are parsed independently
+        TextScanner scanner(begin, begin, end, path);
+        scanner.skip_word("Devices");
+        int device_count = scanner.next_count("device count");
+        const char* devices_begin = scanner.position();
+        const char* devices_end = scanner.find_header();
+
+        scanner.seek(devices_end);
+        scanner.skip_word("Pins");
+        int pin_count = scanner.next_count("pin count");
+        const char* pins_begin = scanner.position();
+        const char* pins_end = scanner.find_header();
+
+        scanner.seek(pins_end);
+        scanner.skip_word("Nets");
+        int net_count = scanner.next_count("net count");
+        const char* nets_begin = scanner.position();
+
+        // every net pin takes at least two bytes of the nets section
+        int net_pin_capacity = (int) std::min<size_t>((end - nets_begin) / 2 + 1, INT32_MAX);
+        LayoutArrays layout = allocate_layout_arrays(device_count, pin_count, net_count, net_pin_capacity);
+
+        unsigned threads = std::min(std::thread::hardware_concurrency(), MAX_PARSE_THREADS);
+        if (file.size() < PARALLEL_PARSE_MIN_BYTES) {
+            threads = 1;
+        }
+
+        SeenIds pin_seen(pin_count);
+        std::vector<std::function<void()>> sections;
+        sections.emplace_back([&] {
+            parse_devices(scanner.range(devices_begin, devices_end), layout);
+        });
+        // pins are the largest section, they get all threads but the two for devices and nets
+        int pin_chunks = threads > 3 ? (int) threads - 2 : 1;
+        if (pin_chunks == 1
+        || !add_pin_chunk_tasks(sections, scanner, pins_begin, pins_end, pin_chunks, layout, pin_seen)) {
+            sections.emplace_back([&] {
+                TextScanner part = scanner.range(pins_begin, pins_end);
+                parse_pins(part, pin_count, layout, pin_seen);
+                if (!part.at_end()) {
+                    part.fail("unexpected data after pins");
+                }
+            });
+        }
+        sections.emplace_back([&] {
+            parse_nets(scanner.range(nets_begin, end), layout, net_pin_capacity);
+        });
+
+        if (threads > 1) {
+            run_tasks(sections);
+        } else {
+            for (auto& section : sections) {
+                section();
+            }
+        }
+
+        return layout;
+    }
+
+} // namespace
+
+LayoutArrays load_layout_arrays(const std::string& path) {
+    if (is_binary_layout(path)) {
+        return map_binary_layout(path);
+    }
+    return parse_text_layout(path);
+}
+
+Layout init_layout_from_file(const std::string &path_to_layout) {
+    return to_layout(load_layout_arrays(path_to_layout));
+}
+
+namespace {
+
+    // text output is formatted into one buffer and written by a single call
+    class TextWriter {
+    public:
+        explicit TextWriter(size_t expected_size)
+        : capacity{std::max<size_t>(expected_size, 64)}, buffer{new char[capacity]} {}
+
+        TextWriter& number(int value) {
+            reserve(11);
+            pos = std::to_chars(buffer.get() + pos, buffer.get() + capacity, value).ptr - buffer.get();
+            return *this;
+        }
+
+        TextWriter& text(const char* s) {
+            size_t len = strlen(s);
+            reserve(len);
+            memcpy(buffer.get() + pos, s, len);
+            pos += len;
+            return *this;
+        }
+
+        TextWriter& ch(char c) {
+            reserve(1);
+            buffer[pos++] = c;
+            return *this;
+        }
+
+        [[nodiscard]] const char* data() const {
+            return buffer.get();
+        }
+
+        [[nodiscard]] size_t size() const {
+            return pos;
+        }
+
+    private:
+        // buffer is left uninitialized, only [0, pos) is ever read
+        void reserve(size_t n) {
+            if (pos + n > capacity) {
+                capacity = std::max(2 * capacity, pos + n);
+                std::unique_ptr<char[]> grown(new char[capacity]);
+                memcpy(grown.get(), buffer.get(), pos);
+                buffer = std::move(grown);
+            }
+        }
+
+        size_t capacity;
+        std::unique_ptr<char[]> buffer;
+        size_t pos{0};
+    };
+
+    void write_whole_file(const std::string& path, const char* data, size_t size) {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Cant open " + path);
+        }
+        size_t written = fwrite(data, 1, size, file);
+        if (fclose(file) != 0 || written != size) {
+            throw std::runtime_error("Cant write " + path);
+        }
+    }
+
+} // namespace
+
+void write_layout_to_file(const std::string& path_to_file, const LayoutView& layout) {
+    // ~12 bytes per number is enough for coordinates and sizes of real layouts
+    TextWriter out(64 + 12 * (5 * (size_t) layout.device_count + 6 * (size_t) layout.pin_count
+                              + 2 * (size_t) layout.net_count + layout.net_pin_count));
+
+    out.text("Devices\n").number(layout.device_count).ch('\n');
+    for (int i = 0; i < layout.device_count; ++i) {
+        out.number(i).ch('\n')
+           .number(layout.center_x[i]).ch(' ').number(layout.center_y[i]).ch(' ')
+           .number(layout.device_half_width[i]).ch(' ').number(layout.device_half_height[i]).ch('\n');
+    }
+
+    out.text("Pins\n").number(layout.pin_count).ch('\n');
+    for (int i = 0; i < layout.pin_count; ++i) {
+        out.number(i).ch('\n')
+           .number(layout.pin_device[i]).ch(' ')
+           .number(layout.pin_x[i]).ch(' ').number(layout.pin_y[i]).ch(' ')
+           .number(layout.pin_half_width[i]).ch(' ').number(layout.pin_half_height[i]).ch('\n');
+    }
+
+    out.text("Nets\n").number(layout.net_count).ch('\n');
+    for (int i = 0; i < layout.net_count; ++i) {
+        out.number(i).ch('\n').number(layout.net_size(i)).ch(' ');
+        for (int j = layout.net_start[i]; j < layout.net_start[i + 1]; ++j) {
+            if (j > layout.net_start[i]) {
+                out.ch(' ');
+            }
+            out.number(layout.net_pins[j]);
+        }
+        out.ch('\n');
+    }
+
+    out.number(layout.bbox_width).ch(' ').number(layout.bbox_height).ch('\n');
+
+    write_whole_file(path_to_file, out.data(), out.size());
+}
+
+void write_layout_to_file(const std::string& path_to_file, const Layout& layout) {
+    write_layout_to_file(path_to_file, to_layout_arrays(layout));
+}
+
+// placement sidecar
+
+void write_placement_to_file(const std::string& path, const LayoutView& layout) {
+    TextWriter out(32 + 24 * (size_t) layout.device_count);
+    out.text("Placement\n").number(layout.device_count).ch('\n');
+    for (int i = 0; i < layout.device_count; ++i) {
+        out.number(i).ch(' ').number(layout.center_x[i]).ch(' ').number(layout.center_y[i]).ch('\n');
+    }
+    write_whole_file(path, out.data(), out.size());
+}
+
+std::vector<Point> read_placement_from_file(const std::string& path) {
+    MappedFile file(path);
+    const char* begin = file.data();
+    TextScanner scanner(begin, begin, begin + file.size(), path);
+    scanner.skip_word("Placement");
+    int device_count = scanner.next_count("device count");
+    std::vector<Point> centers(device_count);
+    SeenIds seen(device_count);
+    for (int i = 0; i < device_count; ++i) {
+        int id = scanner.next_id("device id", device_count, seen);
+        centers[id].x = scanner.next_int("device x");
+        centers[id].y = scanner.next_int("device y");
+    }
+    if (!scanner.at_end()) {
+        scanner.fail("unexpected data after placement");
+    }
+    return centers;
+}
+
+void apply_placement_file(const std::string& layout_path, const std::string& placement_path,
+                          const std::string& output_path) {
+    bool binary = is_binary_layout(layout_path);
+    LayoutArrays layout = load_layout_arrays(layout_path);
+    std::vector<Point> centers = read_placement_from_file(placement_path);
+    if ((int) centers.size() != layout.device_count) {
+        throw std::runtime_error("Placement " + placement_path + " has " + std::to_string(centers.size())
+                                 + " devices, layout has " + std::to_string(layout.device_count));
+    }
+    for (int i = 0; i < layout.device_count; ++i) {
+        layout.set_center(i, centers[i]);
+    }
+    if (binary) {
+        write_binary_layout(output_path, layout);
+    } else {
+        write_layout_to_file(output_path, layout);
+    }
+}
+
+// binary format
+
+namespace {
+
+    using namespace binary_layout;
+
+    uint64_t align_up(uint64_t x) {
+        return (x + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // fills offsets and file_size of header by counts
+    void place_sections(Header& header) {
+        const int64_t counts[SECTION_COUNT]{
+            header.device_cnt, header.device_cnt, header.device_cnt, header.device_cnt,
+            header.pin_cnt, header.pin_cnt, header.pin_cnt, header.pin_cnt, header.pin_cnt,
+            (int64_t) header.net_cnt + 1, header.net_pin_cnt
+        };
+        uint64_t pos = align_up(sizeof(Header));
+        for (int s = 0; s < (int) SECTION_COUNT; ++s) {
+            header.offsets[s] = pos;
+            pos = align_up(pos + counts[s] * sizeof(int32_t));
+        }
+        header.file_size = pos;
+    }
+
+    int* section(char* base, const Header& header, Section s, int64_t count) {
+        if (header.offsets[s] % ALIGNMENT != 0 || header.offsets[s] > header.file_size
+        || count * sizeof(int32_t) > header.file_size - header.offsets[s]) {
+            throw std::runtime_error("Malformed binary layout: bad section " + std::to_string(s));
+        }
+        return reinterpret_cast<int*>(base + header.offsets[s]);
+    }
+
+} // namespace
+
+bool is_binary_layout(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    char magic[sizeof(MAGIC)];
+    bool ret = fread(magic, 1, sizeof(MAGIC), file) == sizeof(MAGIC)
+            && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    fclose(file);
+    return ret;
+}
+
+LayoutArrays map_binary_layout(const std::string& path) {
+    MappedFile file(path);
+    char* base = file.data();
+
+    Header header{};
+    if (file.size() < sizeof(Header)) {
+        throw std::runtime_error("Malformed binary layout: too short");
+    }
+    std::memcpy(&header, base, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a binary layout");
+    }
+    if (header.version != VERSION || header.header_size != sizeof(Header)) {
+        throw std::runtime_error("Unsupported binary layout version " + std::to_string(header.version));
+    }
+    if (header.file_size > file.size() || header.device_cnt < 0 || header.pin_cnt < 0
+    || header.net_cnt < 0 || header.net_pin_cnt < 0) {
+        throw std::runtime_error("Malformed binary layout: bad header");
+    }
+
+    LayoutView view;
+    view.device_count = header.device_cnt;
+    view.pin_count = header.pin_cnt;
+    view.net_count = header.net_cnt;
+    view.net_pin_count = header.net_pin_cnt;
+    view.bbox_width = header.bbox_width;
+    view.bbox_height = header.bbox_height;
+
+    // sections are used in place, the private mapping lets solvers move devices
+    auto array = [&](Section s, int64_t count) {
+        return section(base, header, s, count);
+    };
+    view.center_x = array(DEVICE_CENTER_X, view.device_count);
+    view.center_y = array(DEVICE_CENTER_Y, view.device_count);
+    view.device_half_width = array(DEVICE_HALF_WIDTH, view.device_count);
+    view.device_half_height = array(DEVICE_HALF_HEIGHT, view.device_count);
+    view.pin_device = array(PIN_DEVICE, view.pin_count);
+    view.pin_x = array(PIN_RELATIVE_X, view.pin_count);
+    view.pin_y = array(PIN_RELATIVE_Y, view.pin_count);
+    view.pin_half_width = array(PIN_HALF_WIDTH, view.pin_count);
+    view.pin_half_height = array(PIN_HALF_HEIGHT, view.pin_count);
+    view.net_start = array(NET_START, (int64_t) view.net_count + 1);
+    view.net_pins = array(NET_PINS, view.net_pin_count);
+
+    if (view.net_start[0] != 0 || view.net_start[view.net_count] != view.net_pin_count) {
+        throw std::runtime_error("Malformed binary layout: bad net index");
+    }
+    for (int i = 0; i < view.net_count; ++i) {
+        if (view.net_start[i] > view.net_start[i + 1]) {
+            throw std::runtime_error("Malformed binary layout: bad net index");
+        }
+    }
+    for (int i = 0; i < view.pin_count; ++i) {
+        if (view.pin_device[i] < 0 || view.pin_device[i] >= view.device_count) {
+            throw std::runtime_error("Malformed binary layout: pin " + std::to_string(i)
+                                     + " has no device " + std::to_string(view.pin_device[i]));
+        }
+    }
+    for (int i = 0; i < view.net_pin_count; ++i) {
+        if (view.net_pins[i] < 0 || view.net_pins[i] >= view.pin_count) {
+            throw std::runtime_error("Malformed binary layout: net pin " + std::to_string(i)
+                                     + " has no pin " + std::to_string(view.net_pins[i]));
+        }
+    }
+
+    return {view, std::make_shared<MappedFile>(std::move(file))};
+}
+
+void write_binary_layout(const std::string& path, const LayoutView& layout) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.header_size = sizeof(Header);
+    header.device_cnt = layout.device_count;
+    header.pin_cnt = layout.pin_count;
+    header.net_cnt = layout.net_count;
+    header.net_pin_cnt = layout.net_pin_count;
+    header.bbox_width = layout.bbox_width;
+    header.bbox_height = layout.bbox_height;
+
+    place_sections(header);
+
+    std::vector<char> buffer(header.file_size, 0);
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+
+    auto put = [&buffer, &header](Section s, const int* data, int64_t count) {
+        std::memcpy(buffer.data() + header.offsets[s], data, count * sizeof(int32_t));
+    };
+    put(DEVICE_CENTER_X, layout.center_x, layout.device_count);
+    put(DEVICE_CENTER_Y, layout.center_y, layout.device_count);
+    put(DEVICE_HALF_WIDTH, layout.device_half_width, layout.device_count);
+    put(DEVICE_HALF_HEIGHT, layout.device_half_height, layout.device_count);
+    put(PIN_DEVICE, layout.pin_device, layout.pin_count);
+    put(PIN_RELATIVE_X, layout.pin_x, layout.pin_count);
+    put(PIN_RELATIVE_Y, layout.pin_y, layout.pin_count);
+    put(PIN_HALF_WIDTH, layout.pin_half_width, layout.pin_count);
+    put(PIN_HALF_HEIGHT, layout.pin_half_height, layout.pin_count);
+    put(NET_START, layout.net_start, (int64_t) layout.net_count + 1);
+    put(NET_PINS, layout.net_pins, layout.net_pin_count);
+
+    write_whole_file(path, buffer.data(), buffer.size());
+}
+
+void convert_layout_file(const std::string& input_path, const std::string& output_path) {
+    bool binary = is_binary_layout(input_path);
+    LayoutArrays layout = load_layout_arrays(input_path);
+    if (binary) {
+        write_layout_to_file(output_path, layout);
+    } else {
+        write_binary_layout(output_path, layout);
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Layout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// read-write private (copy-on-write) mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    [[nodiscard]] char* data() const { return ptr; }
+    [[nodiscard]] size_t size() const { return len; }
+
+private:
+    char* ptr{nullptr};
+    size_t len{0};
+};
+
+// Binary layout format, version 1.
+// Header is followed by int32 arrays, every array starts at 64-byte aligned offset header.offsets[section].
+// Device, pin and net ids are implicit array indices, nets are stored as CSR:
+// pins of net i are net_pins[net_start[i]...net_start[i + 1]-1].
+namespace binary_layout {
+
+    constexpr char MAGIC[8] = {'P', 'L', 'C', 'B', 'L', 'A', 'Y', 'T'};
+    constexpr uint32_t VERSION = 1;
+    constexpr uint64_t ALIGNMENT = 64;
+
+    enum Section : uint32_t {
+        DEVICE_CENTER_X,
+        DEVICE_CENTER_Y,
+        DEVICE_HALF_WIDTH,
+        DEVICE_HALF_HEIGHT,
+        PIN_DEVICE,
+        PIN_RELATIVE_X,
+        PIN_RELATIVE_Y,
+        PIN_HALF_WIDTH,
+        PIN_HALF_HEIGHT,
+        NET_START, // net_cnt + 1 entries
+        NET_PINS, // net_pin_cnt entries
+        SECTION_COUNT
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+
+        int32_t device_cnt;
+        int32_t pin_cnt;
+        int32_t net_cnt;
+        int32_t net_pin_cnt;
+
+        int32_t bbox_width;
+        int32_t bbox_height;
+
+        uint64_t file_size;
+        uint64_t offsets[SECTION_COUNT];
+    };
+
+} // namespace binary_layout
+
+// detects binary layout by magic, text layout is parsed otherwise
+LayoutArrays load_layout_arrays(const std::string& path);
+Layout init_layout_from_file(const std::string& input_path);
+
+void write_layout_to_file(const std::string& output_path, const LayoutView& layout);
+void write_layout_to_file(const std::string& output_path, const Layout& layout);
+
+[[nodiscard]] bool is_binary_layout(const std::string& path);
+// arrays point into a private mapping of the file, nothing is copied
+LayoutArrays map_binary_layout(const std::string& path);
+void write_binary_layout(const std::string& path, const LayoutView& layout);
+
+// Placement sidecar, text file with device centers only:
+// Placement
+// <device count>
+// <device id> <x> <y>   (one line per device)
+// It is applied to the layout it was computed for, other device, pin and net data stays there.
+void write_placement_to_file(const std::string& path, const LayoutView& layout);
+std::vector<Point> read_placement_from_file(const std::string& path); // indexed by device id
+
+// layout with centers from placement, written in the format of the input layout
+void apply_placement_file(const std::string& layout_path, const std::string& placement_path,
+                          const std::string& output_path);
+
+// text -> binary or binary -> text, direction is chosen by the input format
+void convert_layout_file(const std::string& input_path, const std::string& output_path);
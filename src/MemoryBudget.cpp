@@ -0,0 +1,87 @@
+#include "MemoryBudget.h"
+#include "../algo/connectivity.h"
+#include "../algo/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <unistd.h>
+
+namespace {
+
+    constexpr double MB = 1 << 20;
+
+    // pin pairs the net model makes of a net of size pins, see append_net_pin_pairs
+    double net_pin_pairs(NetModel model, double size) {
+        if (size <= 1) {
+            return 0;
+        }
+        switch (model) {
+            case NetModel::clique:
+                return size * (size - 1) / 2;
+            case NetModel::star:
+                return size - 1;
+            case NetModel::b2b:
+                return 2 * (2 * size - 3);
+        }
+        return 0;
+    }
+
+    double pin_pairs(const LayoutView& layout, NetModel model) {
+        double ret = 0;
+        for (int net = 0; net < layout.net_count; ++net) {
+            ret += net_pin_pairs(model, layout.net_size(net));
+        }
+        return ret;
+    }
+
+    // capacity a vector reaches by push_back of count elements
+    double grown(double count) {
+        return count <= 1 ? count : std::exp2(std::ceil(std::log2(count)));
+    }
+
+} // namespace
+
+double physical_memory_bytes() {
+    return (double) sysconf(_SC_PHYS_PAGES) * (double) sysconf(_SC_PAGESIZE);
+}
+
+std::string format_bytes(double bytes) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.1f MB", bytes / MB);
+    return buffer;
+}
+
+double device_pair_bound(const LayoutView& layout, NetModel model) {
+    double n = layout.device_count;
+    return std::min(pin_pairs(layout, model), n * (n - 1) / 2);
+}
+
+double connectivity_peak_bytes(const LayoutView& layout, NetModel model) {
+    double records = grown(pin_pairs(layout, model)) * sizeof(ConnectivityModel::Record);
+    double csr = (layout.device_count + 1.0) * sizeof(int)
+                 + 2 * device_pair_bound(layout, model) * (sizeof(int) + sizeof(PairTerms));
+    return records + csr;
+}
+
+double cost_tensor_peak_bytes(const LayoutView& layout, NetModel model, int rows, int cols, int threads) {
+    double n = layout.device_count;
+    double tensor = n * n * n * n * sizeof(long long);
+    // PinPair and both halves of it, see build_cost_tensor
+    double pairs = grown(pin_pairs(layout, model)) * sizeof(PinPair) + pin_pairs(layout, model) * 2 * 32;
+    int workers = std::min(parallel::resolve_threads(threads), std::max(1, layout.device_count));
+    double tables = workers * n * (2.0 * (rows + cols) * sizeof(long long) + 1);
+    return tensor + pairs + tables;
+}
+
+double cost_oracle_peak_bytes(const LayoutView& layout, NetModel model) {
+    return connectivity_peak_bytes(layout, model) + 2.0 * layout.device_count * sizeof(int);
+}
+
+double goto_engine_peak_bytes(const LayoutView& layout, NetModel model, int solutions) {
+    double pairs = device_pair_bound(layout, model);
+    double n = layout.device_count;
+    double engine = pairs * (64 + 4 * sizeof(int)) + (solutions + 16.0) * n * sizeof(long long);
+    return connectivity_peak_bytes(layout, model) + engine;
+}
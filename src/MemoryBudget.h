@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Layout.h"
+#include "NetModel.h"
+
+#include <string>
+
+// Peak memory of the structures the solvers allocate, predicted from the layout before anything is built,
+// so a run can be refused or switched to a smaller cost model up front. Byte counts are doubles:
+// the 2^n DP overflows any integer type long before it is refused.
+
+// RAM of the machine, the budget when none is given
+double physical_memory_bytes();
+
+// "12.5 MB"
+std::string format_bytes(double bytes);
+
+// build_connectivity: its records, at most one per pin pair the model makes, and the CSR it merges them into
+double connectivity_peak_bytes(const LayoutView& layout, NetModel model);
+
+// build_cost_tensor: the n^4 tensor, pin pairs and the per-thread difference tables
+double cost_tensor_peak_bytes(const LayoutView& layout, NetModel model, int rows, int cols, int threads);
+
+// build_cost_oracle: the connectivity it keeps and its location arrays
+double cost_oracle_peak_bytes(const LayoutView& layout, NetModel model);
+
+// GotoHeurist and NewGotoHeurist with the connectivity they are built from: a 64-byte record per device pair,
+// the adjacency and per device arrays of every one of solutions kept permutations
+double goto_engine_peak_bytes(const LayoutView& layout, NetModel model, int solutions);
+
+// device pairs sharing a net, bounded by the pin pairs of the model and n (n - 1) / 2
+double device_pair_bound(const LayoutView& layout, NetModel model);
@@ -0,0 +1,207 @@
+#include "Metrics.h"
+
+#include "../algo/parallel.h"
+
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PLACER_HAVE_AVX2_KERNELS 1
+#include <immintrin.h>
+#endif
+
+unsigned parse_metrics(const std::string& list) {
+    unsigned mask = 0;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string name = list.substr(pos, end - pos);
+        if (name == "all") {
+            mask |= METRIC_ALL;
+        } else if (name == "manhattan") {
+            mask |= METRIC_MANHATTAN;
+        } else if (name == "hp") {
+            mask |= METRIC_HALF_P;
+        } else if (name == "clique") {
+            mask |= METRIC_CLIQUE;
+        } else if (name == "hybrid") {
+            mask |= METRIC_HYBRID;
+        } else if (!name.empty()) {
+            throw std::runtime_error("Unknown metric " + name + ", expected manhattan, hp, clique, hybrid or all");
+        }
+        pos = end + 1;
+    }
+    return mask;
+}
+
+namespace {
+
+#ifdef PLACER_HAVE_AVX2_KERNELS
+
+    // Built with the target attribute, so the rest of the module needs no -mavx2
+    // and these are only called after the CPU check in metric_kernels().
+
+    __attribute__((target("avx2")))
+    int hmin(__m256i v) {
+        __m128i m = _mm_min_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(m);
+    }
+
+    __attribute__((target("avx2")))
+    int hmax(__m256i v) {
+        __m128i m = _mm_max_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(m);
+    }
+
+    __attribute__((target("avx2")))
+    __m256i load8(const int* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    // size >= 8, the tail is covered by an overlapping load of the last 8 values
+    __attribute__((target("avx2")))
+    double half_p_avx2(const int* xs, const int* ys, int size) {
+        __m256i min_x = load8(xs), max_x = min_x;
+        __m256i min_y = load8(ys), max_y = min_y;
+        for (int i = 8; i < size; i += 8) {
+            int at = std::min(i, size - 8);
+            __m256i x = load8(xs + at);
+            __m256i y = load8(ys + at);
+            min_x = _mm256_min_epi32(min_x, x);
+            max_x = _mm256_max_epi32(max_x, x);
+            min_y = _mm256_min_epi32(min_y, y);
+            max_y = _mm256_max_epi32(max_y, y);
+        }
+        return ((hmax(max_x) - hmin(min_x)) + (hmax(max_y) - hmin(min_y))) / 2.0;
+    }
+
+    __attribute__((target("avx2")))
+    long long pair_manhattan_avx2(const int* xs, const int* ys, int size) {
+        __m256i acc = _mm256_setzero_si256();
+        long long tail = 0;
+        for (int i = 0; i < size; ++i) {
+            __m256i xi = _mm256_set1_epi32(xs[i]);
+            __m256i yi = _mm256_set1_epi32(ys[i]);
+            int j = i + 1;
+            for (; j + 8 <= size; j += 8) {
+                __m256i d = _mm256_add_epi32(_mm256_abs_epi32(_mm256_sub_epi32(load8(xs + j), xi)),
+                                             _mm256_abs_epi32(_mm256_sub_epi32(load8(ys + j), yi)));
+                // widened to 64 bits before accumulation, 8 int lanes would overflow on large nets
+                acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(d)));
+                acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(d, 1)));
+            }
+            for (; j < size; ++j) {
+                tail += std::abs(xs[j] - xs[i]) + std::abs(ys[j] - ys[i]);
+            }
+        }
+        alignas(32) long long lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        return tail + lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+
+    __attribute__((target("avx2")))
+    double pair_euclid_avx2(const int* xs, const int* ys, int size) {
+        __m256d acc = _mm256_setzero_pd();
+        double tail = 0;
+        for (int i = 0; i < size; ++i) {
+            __m256d xi = _mm256_set1_pd(xs[i]);
+            __m256d yi = _mm256_set1_pd(ys[i]);
+            int j = i + 1;
+            for (; j + 4 <= size; j += 4) {
+                __m256d dx = _mm256_sub_pd(_mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + j))), xi);
+                __m256d dy = _mm256_sub_pd(_mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + j))), yi);
+                acc = _mm256_add_pd(acc, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+            }
+            for (; j < size; ++j) {
+                double dx = xs[j] - xs[i];
+                double dy = ys[j] - ys[i];
+                tail += std::sqrt(dx * dx + dy * dy);
+            }
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, acc);
+        return tail + ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3]));
+    }
+
+    // crossover points measured with bench_metrics
+    const MetricKernels AVX2_KERNELS{"avx2", half_p_avx2, pair_manhattan_avx2, pair_euclid_avx2, 768};
+
+#endif
+
+    const MetricKernels SCALAR_KERNELS{"scalar", net_half_p, net_pair_manhattan, net_pair_euclid, 128};
+
+    const MetricKernels& select_metric_kernels() {
+#ifdef PLACER_HAVE_AVX2_KERNELS
+        if (__builtin_cpu_supports("avx2")) {
+            return AVX2_KERNELS;
+        }
+#endif
+        return SCALAR_KERNELS;
+    }
+
+    using Evaluator = MetricTotals (*)(const LayoutView&, int, int);
+
+    template<size_t... Masks>
+    constexpr std::array<Evaluator, sizeof...(Masks)> make_evaluators(std::index_sequence<Masks...>) {
+        return {&evaluate_metrics<Masks>...};
+    }
+
+    constexpr auto EVALUATORS = make_evaluators(std::make_index_sequence<METRIC_ALL + 1>{});
+
+} // namespace
+
+std::vector<int> metric_chunks(const LayoutView& layout) {
+    std::vector<int> bounds{0};
+    int pins = 0;
+    for (int net = 0; net < layout.net_count; ++net) {
+        pins += layout.net_size(net);
+        if (pins >= METRIC_CHUNK_PINS) {
+            bounds.push_back(net + 1);
+            pins = 0;
+        }
+    }
+    if (bounds.back() != layout.net_count) {
+        bounds.push_back(layout.net_count);
+    }
+    return bounds;
+}
+
+MetricTotals evaluate_metrics(const LayoutView& layout, unsigned mask, int threads) {
+    Evaluator evaluator = EVALUATORS[mask & METRIC_ALL];
+    std::vector<int> bounds = metric_chunks(layout);
+    int chunks = (int) bounds.size() - 1;
+    if (chunks <= 1) {
+        return evaluator(layout, 0, layout.net_count);
+    }
+
+    std::vector<MetricTotals> partial(chunks);
+    parallel::for_each_index(chunks, threads, [&](int c) {
+        partial[c] = evaluator(layout, bounds[c], bounds[c + 1]);
+    });
+
+    MetricTotals totals;
+    for (const MetricTotals& p : partial) {
+        totals.manhattan += p.manhattan;
+        totals.half_p += p.half_p;
+        totals.clique += p.clique;
+        totals.hybrid += p.hybrid;
+    }
+    return totals;
+}
+
+const MetricKernels& scalar_metric_kernels() {
+    return SCALAR_KERNELS;
+}
+
+const MetricKernels& metric_kernels() {
+    static const MetricKernels& kernels = select_metric_kernels();
+    return kernels;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "Layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Wirelength metrics, a mask selects which of them an evaluation computes.
+enum Metric : unsigned {
+    METRIC_MANHATTAN = 1u << 0,
+    METRIC_HALF_P = 1u << 1,
+    METRIC_CLIQUE = 1u << 2,
+    METRIC_HYBRID = 1u << 3,
+    METRIC_ALL = METRIC_MANHATTAN | METRIC_HALF_P | METRIC_CLIQUE | METRIC_HYBRID
+};
+
+struct MetricTotals {
+    double manhattan{0};
+    double half_p{0};
+    double clique{0};
+    double hybrid{0};
+};
+
+// comma separated list of manhattan, hp, clique, hybrid or "all"
+unsigned parse_metrics(const std::string& list);
+
+// Per-net kernels over absolute pin coordinates of one net.
+
+inline double net_half_p(const int* xs, const int* ys, int size) {
+    if (size == 0) {
+        return 0;
+    }
+    int min_x = xs[0], max_x = xs[0];
+    int min_y = ys[0], max_y = ys[0];
+    for (int i = 1; i < size; ++i) {
+        min_x = std::min(min_x, xs[i]);
+        max_x = std::max(max_x, xs[i]);
+        min_y = std::min(min_y, ys[i]);
+        max_y = std::max(max_y, ys[i]);
+    }
+    return ((max_x - min_x) + (max_y - min_y)) / 2.0;
+}
+
+// sum of pairwise manhattan distances, not normalized
+inline long long net_pair_manhattan(const int* xs, const int* ys, int size) {
+    long long ret = 0;
+    for (int i = 0; i < size; ++i) {
+        for (int j = i + 1; j < size; ++j) {
+            ret += std::abs(xs[j] - xs[i]) + std::abs(ys[j] - ys[i]);
+        }
+    }
+    return ret;
+}
+
+// sum of |v[i] - v[j]| over all pairs, sorts values in place: sum of v[i] * (2i - size + 1)
+inline long long sorted_pair_abs_sum(int* values, int size) {
+    std::sort(values, values + size);
+    long long ret = 0;
+    for (int i = 0; i < size; ++i) {
+        ret += 1ll * values[i] * (2 * i - size + 1);
+    }
+    return ret;
+}
+
+// same as net_pair_manhattan in O(size log size), scratch holds size ints
+inline long long net_pair_manhattan_sorted(const int* xs, const int* ys, int size, int* scratch) {
+    std::copy(xs, xs + size, scratch);
+    long long ret = sorted_pair_abs_sum(scratch, size);
+    std::copy(ys, ys + size, scratch);
+    return ret + sorted_pair_abs_sum(scratch, size);
+}
+
+// sum of pairwise euclidean distances, not normalized
+inline double net_pair_euclid(const int* xs, const int* ys, int size) {
+    double ret = 0;
+    for (int i = 0; i < size; ++i) {
+        for (int j = i + 1; j < size; ++j) {
+            double dx = xs[j] - xs[i];
+            double dy = ys[j] - ys[i];
+            ret += std::sqrt(dx * dx + dy * dy);
+        }
+    }
+    return ret;
+}
+
+// Kernel set used by evaluate_metrics for nets of at least SIMD_MIN_NET_SIZE pins
+// (SIMD_MIN_PAIR_NET_SIZE for the pairwise ones), smaller nets always go to the inline
+// scalar kernels above.
+struct MetricKernels {
+    const char* name;
+    double (*half_p)(const int* xs, const int* ys, int size);
+    long long (*pair_manhattan)(const int* xs, const int* ys, int size);
+    double (*pair_euclid)(const int* xs, const int* ys, int size);
+    // from this net size manhattan pair sums go through net_pair_manhattan_sorted instead
+    int sorted_pair_min_size;
+};
+
+constexpr int SIMD_MIN_NET_SIZE = 8;
+constexpr int SIMD_MIN_PAIR_NET_SIZE = 16;
+
+const MetricKernels& scalar_metric_kernels();
+// AVX2 kernels if the CPU supports them, scalar otherwise; chosen once per process
+const MetricKernels& metric_kernels();
+
+// pair manhattan sum of one net by the fastest path for its size, scratch holds size ints
+inline long long net_pair_manhattan_best(const MetricKernels& kernels, const int* xs, const int* ys, int size,
+                                         int* scratch) {
+    if (size >= kernels.sorted_pair_min_size) {
+        return net_pair_manhattan_sorted(xs, ys, size, scratch);
+    }
+    return size >= SIMD_MIN_PAIR_NET_SIZE ? kernels.pair_manhattan(xs, ys, size)
+                                          : net_pair_manhattan(xs, ys, size);
+}
+
+// One pass over nets [net_begin, net_end) for all metrics in Mask. Per-net values are summed in net order;
+// vector kernels add euclidean pair distances in a different order, so clique and hybrid
+// of large nets may differ from net_pair_euclid in the last bits.
+template<unsigned Mask>
+MetricTotals evaluate_metrics(const LayoutView& layout, int net_begin, int net_end) {
+    constexpr bool need_pairs = (Mask & (METRIC_MANHATTAN | METRIC_CLIQUE | METRIC_HYBRID)) != 0;
+    constexpr bool need_euclid = (Mask & (METRIC_CLIQUE | METRIC_HYBRID)) != 0;
+
+    int max_size = 0;
+    for (int net = net_begin; net < net_end; ++net) {
+        max_size = std::max(max_size, layout.net_size(net));
+    }
+    std::vector<int> xs(max_size), ys(max_size);
+    std::vector<int> scratch((Mask & METRIC_MANHATTAN) != 0 ? max_size : 0);
+    const MetricKernels& kernels = metric_kernels();
+
+    MetricTotals totals;
+    for (int net = net_begin; net < net_end; ++net) {
+        int size = layout.net_size(net);
+        if constexpr (!(Mask & METRIC_HALF_P)) {
+            if (size <= 1) {
+                continue;
+            }
+        }
+
+        const int* pins = layout.net_pins + layout.net_start[net];
+        for (int i = 0; i < size; ++i) {
+            xs[i] = layout.pin_abs_x(pins[i]);
+            ys[i] = layout.pin_abs_y(pins[i]);
+        }
+
+        if constexpr ((Mask & METRIC_HALF_P) != 0) {
+            totals.half_p += size >= SIMD_MIN_NET_SIZE ? kernels.half_p(xs.data(), ys.data(), size)
+                                                       : net_half_p(xs.data(), ys.data(), size);
+        }
+
+        if constexpr (need_pairs) {
+            if (size <= 1) {
+                continue;
+            }
+            bool wide = size >= SIMD_MIN_PAIR_NET_SIZE;
+            double cf = 1.0 / static_cast<double>(size - 1);
+            if constexpr ((Mask & METRIC_MANHATTAN) != 0) {
+                long long pairs = net_pair_manhattan_best(kernels, xs.data(), ys.data(), size, scratch.data());
+                totals.manhattan += static_cast<double>(pairs) * cf;
+            }
+            if constexpr (need_euclid) {
+                double pairs = wide ? kernels.pair_euclid(xs.data(), ys.data(), size)
+                                    : net_pair_euclid(xs.data(), ys.data(), size);
+                double clique = pairs / static_cast<double>(size - 1);
+                if constexpr ((Mask & METRIC_CLIQUE) != 0) {
+                    totals.clique += clique;
+                }
+                if constexpr ((Mask & METRIC_HYBRID) != 0) {
+                    totals.hybrid += size <= 3 ? clique : clique * (double) size;
+                }
+            }
+        }
+    }
+    return totals;
+}
+
+template<unsigned Mask>
+MetricTotals evaluate_metrics(const LayoutView& layout) {
+    return evaluate_metrics<Mask>(layout, 0, layout.net_count);
+}
+
+// Nets are cut into consecutive chunks of about METRIC_CHUNK_PINS pins, a larger net ends its own chunk.
+// Chunks do not depend on the thread count and their totals are added in chunk order,
+// so the result is the same for any number of threads.
+constexpr int METRIC_CHUNK_PINS = 1 << 15;
+
+std::vector<int> metric_chunks(const LayoutView& layout); // chunk boundaries, first 0 and last net_count
+
+// runtime mask, dispatches to the matching evaluate_metrics<Mask> on every chunk;
+// threads <= 0 means all hardware threads
+MetricTotals evaluate_metrics(const LayoutView& layout, unsigned mask, int threads = 1);
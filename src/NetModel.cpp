@@ -0,0 +1,86 @@
+#include "NetModel.h"
+
+#include <stdexcept>
+#include <utility>
+
+NetModel parse_net_model(const std::string& name) {
+    if (name == "clique") {
+        return NetModel::clique;
+    }
+    if (name == "star") {
+        return NetModel::star;
+    }
+    if (name == "b2b") {
+        return NetModel::b2b;
+    }
+    throw std::runtime_error("Unknown net model " + name + ", expected clique, star or b2b");
+}
+
+namespace {
+
+    void add_pair(const LayoutView& layout, int a, int b, long long wx, long long wy, std::vector<PinPair>& pairs) {
+        if (layout.pin_device[a] != layout.pin_device[b]) {
+            pairs.push_back({a, b, wx, wy});
+        }
+    }
+
+    // both bounds and every inner pin to each of them along one axis, by coords[i] of pins[i]
+    template<typename Coord>
+    void add_b2b_axis(const LayoutView& layout, const int* pins, int size, Coord coord, long long w, bool x,
+                      std::vector<PinPair>& pairs) {
+        int lo = 0, hi = 1;
+        if (coord(pins[hi]) < coord(pins[lo])) {
+            std::swap(lo, hi);
+        }
+        for (int i = 2; i < size; ++i) {
+            if (coord(pins[i]) < coord(pins[lo])) {
+                lo = i;
+            } else if (coord(pins[i]) > coord(pins[hi])) {
+                hi = i;
+            }
+        }
+        long long wx = x ? w : 0;
+        long long wy = x ? 0 : w;
+        add_pair(layout, pins[lo], pins[hi], wx, wy, pairs);
+        for (int i = 0; i < size; ++i) {
+            if (i != lo && i != hi) {
+                add_pair(layout, pins[lo], pins[i], wx, wy, pairs);
+                add_pair(layout, pins[hi], pins[i], wx, wy, pairs);
+            }
+        }
+    }
+
+} // namespace
+
+void append_net_pin_pairs(const LayoutView& layout, NetModel model, int net, std::vector<PinPair>& pairs) {
+    int size = layout.net_size(net);
+    if (size <= 1) {
+        return;
+    }
+    const int* pins = layout.net_pins + layout.net_start[net];
+
+    switch (model) {
+        case NetModel::clique: {
+            long long w = net_weight(1, size - 1);
+            for (int i = 0; i < size; ++i) {
+                for (int j = i + 1; j < size; ++j) {
+                    add_pair(layout, pins[i], pins[j], w, w, pairs);
+                }
+            }
+            break;
+        }
+        case NetModel::star: {
+            long long w = net_weight(2, size);
+            for (int i = 1; i < size; ++i) {
+                add_pair(layout, pins[0], pins[i], w, w, pairs);
+            }
+            break;
+        }
+        case NetModel::b2b: {
+            long long w = net_weight(1, size - 1);
+            add_b2b_axis(layout, pins, size, [&](int p) { return layout.pin_abs_x(p); }, w, true, pairs);
+            add_b2b_axis(layout, pins, size, [&](int p) { return layout.pin_abs_y(p); }, w, false, pairs);
+            break;
+        }
+    }
+}
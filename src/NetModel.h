@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Layout.h"
+
+#include <string>
+#include <vector>
+
+// How the grid solvers split a net of k pins into weighted pin pairs:
+//   clique - every pin pair, weight 1 / (k - 1), O(k^2) pairs;
+//   star   - every pin to the first pin of the net, weight 2 / k, O(k) pairs;
+//   b2b    - bound-to-bound: along each axis every pin to both extreme pins of the input placement and
+//            the extremes to each other, weight 1 / (k - 1), O(k) pairs. At that placement it sums to the
+//            net's extent along the axis; for k <= 3 it is the clique.
+enum class NetModel {
+    clique,
+    star,
+    b2b
+};
+
+// "clique", "star" or "b2b"
+NetModel parse_net_model(const std::string& name);
+
+// Weights are fixed point in units of 1 / NET_WEIGHT_SCALE instead of multiples of the LCM of all
+// net sizes minus one, which overflows for mixed net sizes. lcm(1..16): clique and star weights
+// of nets up to 17 pins are exact, larger ones are rounded to the nearest unit.
+constexpr long long NET_WEIGHT_SCALE = 720720;
+
+// num / den in NET_WEIGHT_SCALE units, rounded
+inline long long net_weight(long long num, long long den) {
+    return (NET_WEIGHT_SCALE * num + den / 2) / den;
+}
+
+struct PinPair {
+    int a; // pins of different devices
+    int b;
+    long long wx; // weight along x, 0 if the pins are connected along y only
+    long long wy;
+};
+
+// pin pairs the model makes of one net, appended to pairs; pairs within one device are skipped
+void append_net_pin_pairs(const LayoutView& layout, NetModel model, int net, std::vector<PinPair>& pairs);
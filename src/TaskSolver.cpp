@@ -4,6 +4,7 @@
 //
 
 #include "TaskSolver.h"
+#include "MemoryBudget.h"
 
 #include <cmath>
 #include <random>
@@ -34,10 +35,12 @@ void get_value_nodef(const py::kwargs& kwargs, const std::string& name, int& val
     }
 }
 
-void destroy_layout(Layout& layout) {
-    delete[] layout.devices;
-    delete[] layout.pins;
-    delete[] layout.nets;
+void get_value_str(const py::kwargs& kwargs, const std::string& name, std::string& val, const std::string& def) {
+    if (!kwargs.contains(name) || kwargs[name.c_str()].is_none()) {
+        val = def;
+    } else {
+        val = kwargs[name.c_str()].cast<std::string>();
+    }
 }
 
 Point get_offset(int width, int height, int step_x, int step_y, int rows, int cols, int device_hwidth, int device_hheight) {
@@ -46,131 +49,6 @@ Point get_offset(int width, int height, int step_x, int step_y, int rows, int co
     return {(width - w) / 2, (height - h) / 2};
 }
 
-Layout init_layout_from_file(const std::string &path_to_layout) {
-    FILE* file = fopen(path_to_layout.c_str(), "r");
-    const int BUFLEN = 1024;
-    char temp_buffer[BUFLEN];
-
-    fscanf(file, "%s", temp_buffer); // devices
-    int device_count;
-    fscanf(file, "%d", &device_count);
-    Device* devices = new Device[device_count];
-    for (int i = 0; i < device_count; ++i) {
-        int id;
-        fscanf(file, "%d", &id);
-        devices[id].id = id;
-        fscanf(file, "%d %d %d %d",
-              &devices[id].center.x, &devices[id].center.y,
-              &devices[id].half_width, &devices[id].half_height);
-    }
-
-    fscanf(file, "%s", temp_buffer); // pins
-    int pin_count;
-    fscanf(file, "%d", &pin_count);
-    Pin* pins = new Pin[pin_count];
-    for (int i = 0; i < pin_count; ++i) {
-        int id;
-        fscanf(file, "%d", &id);
-        pins[id].id = id;
-        int assigned_device_id;
-        fscanf(file, "%d", &assigned_device_id);
-        pins[id].assigned_device = devices + assigned_device_id;
-        fscanf(file, "%d %d %d %d",
-               &pins[id].relative.x,
-               &pins[id].relative.y,
-               &pins[id].half_width,
-               &pins[id].half_height);
-    }
-
-    fscanf(file, "%s", temp_buffer); // nets
-    int net_count;
-    fscanf(file, "%d", &net_count);
-    Net* nets = new Net[net_count];
-    for (int i = 0; i < net_count; ++i) {
-        int id;
-        fscanf(file, "%d", &id);
-        nets[id].id = id;
-        int net_size;
-        fscanf(file, "%d", &net_size);
-        nets[id].pins.reserve(net_size);
-        for (int j = 0; j < net_size; ++j) {
-            int pin_id;
-            fscanf(file, "%d", &pin_id);
-            nets[id].pins.push_back(pins + pin_id);
-        }
-    }
-
-    int x, y;
-    int bbox_width{0};
-    int bbox_height{0};
-    if (fscanf(file, "%d%d", &x, &y)) {
-        bbox_width = x;
-        bbox_height = y;
-        // printf("inited width, height: %d %d\n", bbox_width, bbox_height);
-    }
-
-    fclose(file);
-
-    return Layout{
-        devices, pins, nets,
-        device_count, pin_count, net_count,
-        bbox_width, bbox_height
-    };
-}
-
-void write_layout_to_file(const std::string& path_to_file, const Layout& layout) {
-    // puts("writing layout to file...");
-    FILE* file = fopen(path_to_file.c_str(), "w");
-    // puts("opened file");
-
-    fprintf(file, "Devices\n"); // devices
-    // puts("printed devices (name)");
-    int device_count = layout.device_cnt;
-    auto devices = layout.devices;
-    fprintf(file, "%d\n", device_count);
-    for (int i = 0; i < device_count; ++i) {
-        fprintf(file, "%d\n%d %d %d %d\n",
-                devices[i].id, devices[i].center.x, devices[i].center.y,
-                devices[i].half_width, devices[i].half_height);
-    }
-    // puts("printed all devices");
-
-    fprintf(file, "Pins\n"); // pins
-    // puts("printed pins (name)");
-    int pin_count = layout.pin_cnt;
-    auto pins = layout.pins;
-    fprintf(file, "%d\n", pin_count);
-    for (int i = 0; i < pin_count; ++i) {
-        fprintf(file, "%d\n%d %d %d %d %d\n", pins[i].id, pins[i].assigned_device->id,
-                pins[i].relative.x, pins[i].relative.y,
-                pins[i].half_width,
-                pins[i].half_height);
-    }
-    // puts("printer all pins");
-
-    fprintf(file, "Nets\n"); // nets
-    // puts("printed nets (name)");
-    int net_count = layout.net_cnt;
-    auto nets = layout.nets;
-    fprintf(file, "%d\n", net_count);
-    for (int i = 0; i < net_count; ++i) {
-        int net_size = (int) nets[i].pins.size();
-        fprintf(file, "%d\n%d ", nets[i].id, net_size);
-        for (int j = 0; j < net_size; ++j) {
-            fprintf(file, "%d", nets[i].pins[j]->id);
-            if (j + 1 < (int) net_size) {
-                fprintf(file, " ");
-            } 
-        }
-        fprintf(file, "\n");
-    }
-    // puts("printed all nets");
-
-    fprintf(file, "%d %d\n", layout.bbox_width, layout.bbox_height);
-
-    fclose(file);
-}
-
 int rand_int(int l, int r, std::mt19937& rnd) {
     return rnd() % (r - l + 1) + l;
 }
@@ -471,193 +349,102 @@ Layout random_cluster_layout(
 }
 
 void TaskSolver::init_layout(const std::string &path_to_layout) {
-    FILE* file = fopen(path_to_layout.c_str(), "r");
-    const int BUFLEN = 1024;
-    char temp_buffer[BUFLEN];
-
-    fscanf(file, "%s", temp_buffer); // devices
-    fscanf(file, "%d", &device_count);
-    devices = new Device[device_count];
-    for (int i = 0; i < device_count; ++i) {
-        int id;
-        fscanf(file, "%d", &id);
-        devices[id].id = id;
-        fscanf(file, "%d %d %d %d",
-              &devices[id].center.x, &devices[id].center.y,
-              &devices[id].half_width, &devices[id].half_height);
-    }
+    layout = load_layout_arrays(path_to_layout);
 
-    fscanf(file, "%s", temp_buffer); // pins
-    fscanf(file, "%d", &pin_count);
-    pins = new Pin[pin_count];
-    for (int i = 0; i < pin_count; ++i) {
-        int id;
-        fscanf(file, "%d", &id);
-        pins[id].id = id;
-        int assigned_device_id;
-        fscanf(file, "%d", &assigned_device_id);
-        pins[id].assigned_device = devices + assigned_device_id;
-        fscanf(file, "%d %d %d %d",
-               &pins[id].relative.x,
-               &pins[id].relative.y,
-               &pins[id].half_width,
-               &pins[id].half_height);
-    }
+    device_count = layout.device_count;
+    pin_count = layout.pin_count;
+    net_count = layout.net_count;
 
-    fscanf(file, "%s", temp_buffer); // nets
-    fscanf(file, "%d", &net_count);
-    nets = new Net[net_count];
-    for (int i = 0; i < net_count; ++i) {
-        int id;
-        fscanf(file, "%d", &id);
-        nets[id].id = id;
-        int net_size;
-        fscanf(file, "%d", &net_size);
-        nets[id].pins.reserve(net_size);
-        for (int j = 0; j < net_size; ++j) {
-            int pin_id;
-            fscanf(file, "%d", &pin_id);
-            nets[id].pins.push_back(pins + pin_id);
-        }
+    if (layout.bbox_width > 0 && layout.bbox_height > 0) {
+        screen_width = layout.bbox_width;
+        screen_height = layout.bbox_height;
     }
-
-    int x, y;
-    if (fscanf(file, "%d%d", &x, &y)) {
-        screen_width = x;
-        screen_height = y;
-        // printf("inited width, height: %d %d\n", screen_width, screen_height);
-    }
-
-    fclose(file);
 }
 
 void TaskSolver::write_layout(const std::string &path_to_file) {
-    FILE* file = fopen(path_to_file.c_str(), "w");
-
-    fprintf(file, "Devices\n"); // devices
-    fprintf(file, "%d\n", device_count);
-    for (int i = 0; i < device_count; ++i) {
-        fprintf(file, "%d\n%d %d %d %d\n",
-                devices[i].id, devices[i].center.x, devices[i].center.y,
-                devices[i].half_width, devices[i].half_height);
-    }
+    write_layout_to_file(path_to_file, current_layout());
+}
 
-    fprintf(file, "Pins\n"); // pins
-    fprintf(file, "%d\n", pin_count);
-    for (int i = 0; i < pin_count; ++i) {
-        fprintf(file, "%d\n%d %d %d %d %d\n", pins[i].id, pins[i].assigned_device->id,
-                pins[i].relative.x, pins[i].relative.y,
-                pins[i].half_width,
-                pins[i].half_height);
-    }
+void TaskSolver::init_common(const py::str& input_path, const py::str& output_path, const py::kwargs& kwargs) {
+    init_layout(input_path.cast<std::string>());
+    output_layout_path = output_path.cast<std::string>();
 
-    fprintf(file, "Nets\n"); // nets
-    fprintf(file, "%d\n", net_count);
-    for (int i = 0; i < net_count; ++i) {
-        int net_size = (int) nets[i].pins.size();
-        fprintf(file, "%d\n%d ", nets[i].id, net_size);
-        for (int j = 0; j < net_size; ++j) {
-            fprintf(file, "%d", nets[i].pins[j]->id);
-            if (j + 1 < (int) net_size) {
-                fprintf(file, " ");
-            } 
-        }
-        fprintf(file, "\n");
-    }
+    get_value(kwargs, placement_only_name, placement_only, DEFAULT_PLACEMENT_ONLY);
+
+    std::string metrics_list;
+    get_value_str(kwargs, metrics_name, metrics_list, DEFAULT_METRICS);
+    metrics = parse_metrics(metrics_list);
+
+    get_value(kwargs, threads_name, threads, DEFAULT_THREADS);
+
+    std::string net_model_str;
+    get_value_str(kwargs, net_model_name, net_model_str, DEFAULT_NET_MODEL);
+    net_model = parse_net_model(net_model_str);
 
-    fprintf(file, "%d %d\n", screen_width, screen_height);
+    get_value_str(kwargs, cost_cache_name, cost_cache, DEFAULT_COST_CACHE);
 
-    fclose(file);
+    int budget_mb;
+    get_value(kwargs, memory_budget_name, budget_mb, DEFAULT_MEMORY_BUDGET);
+    memory_budget = budget_mb > 0 ? budget_mb * double(1 << 20) : physical_memory_bytes();
 }
 
-TaskSolver::~TaskSolver() {
-    delete[] devices;
-    delete[] pins;
-    delete[] nets;
+void TaskSolver::check_memory(double peak) const {
+    if (peak > memory_budget) {
+        throw std::runtime_error("Needs " + format_bytes(peak) + ", memory budget is " + format_bytes(memory_budget));
+    }
 }
 
-double TaskSolver::get_cpu(int start) {
-    return round((static_cast<double>(clock() - start) / 1e6) * 100) / 100;
+void TaskSolver::add_peak_memory(Params& p, double peak) const {
+    p.push_back({peak_memory, format_bytes(peak), false});
 }
 
-double TaskSolver::calc_metric(std::function<double(const Net *)> &&metric) const {
-    double res = 0;
-    for (int i = 0; i < net_count; ++i) {
-        res += metric(nets + i);
+void TaskSolver::write_output() {
+    if (placement_only) {
+        write_placement_to_file(output_layout_path, current_layout());
+    } else {
+        write_layout(output_layout_path);
     }
-    return res;
 }
 
-void TaskSolver::add_debug_info(Params& p, double t, std::function<double(const Net*)>&& metric) const {
-    p.push_back({"di_" + std::to_string(t), std::to_string(calc_metric(std::move(metric))), false});
+LayoutView TaskSolver::current_layout() const {
+    LayoutView view = layout;
+    view.bbox_width = screen_width;
+    view.bbox_height = screen_height;
+    return view;
 }
 
-double calc_half_p(const Net* net) {
-    if (net->pins.empty()) {
-        return 0;
-    }
+TaskSolver::~TaskSolver() = default;
 
-    int max_x = (int) -1e8;
-    int max_y = max_x;
-    int min_x = -max_x;
-    int min_y = -max_y;
-
-    for (const Pin* p : net->pins) {
-        auto [x, y] = p->absolute();
-        max_x = std::max(max_x, x);
-        max_y = std::max(max_y, y);
-        min_x = std::min(min_x, x);
-        min_y = std::min(min_y, y);
-    }
+double TaskSolver::get_cpu(int start) {
+    return round((static_cast<double>(clock() - start) / 1e6) * 100) / 100;
+}
 
-    return ((max_x - min_x) + (max_y - min_y)) / 2.0;
+double TaskSolver::calc_twl() const {
+    return evaluate_metrics(layout, METRIC_MANHATTAN, threads).manhattan;
 }
 
-double calc_clique(const Net* net) {
-    auto pins = net->pins;
-    if (pins.size() <= 1) {
-        return 0;
+void TaskSolver::add_metrics(Params& p) const {
+    MetricTotals totals = evaluate_metrics(layout, metrics, threads);
+    if (metrics & METRIC_MANHATTAN) {
+        p.push_back({TWL_manhattan, my_round(totals.manhattan), false});
     }
-
-    double ret = 0;
-
-    for (int i = 0; i < (int) pins.size(); ++i) {
-        auto [x1, y1] = pins[i]->absolute();
-        for (int j = i + 1; j < (int) pins.size(); ++j) {
-            auto [x2, y2] = pins[j]->absolute();
-            int dx = x2 - x1;
-            int dy = y2 - y1;
-            ret += std::sqrt(dx * dx + dy * dy);
-        }
+    if (metrics & METRIC_HALF_P) {
+        p.push_back({TWL_HP, my_round(totals.half_p), false});
+    }
+    if (metrics & METRIC_CLIQUE) {
+        p.push_back({TWL_clique, my_round(totals.clique), false});
+    }
+    if (metrics & METRIC_HYBRID) {
+        p.push_back({TWL_hybrid, my_round(totals.hybrid), false});
     }
-
-    return ret / static_cast<double>(pins.size() - 1);
 }
 
-double calc_hybrid(const Net* net) {
-    auto pins = net->pins;
-    if (pins.size() <= 3) {
-        return calc_clique(net);
-    } else {
-        return calc_clique(net) * (double) pins.size();
-    }
+void TaskSolver::add_debug_info(Params& p, double t, double twl) const {
+    p.push_back({"di_" + std::to_string(t), std::to_string(twl), false});
 }
 
-double calc_manhattan(const Net* net) {
-    auto pins = net->pins;
-    if (pins.size() <= 1) {
-        return 0.0;
-    }
-    double cf = 1.0 / static_cast<double>(pins.size() - 1);
-    double ret = 0;
-    for (int i = 0; i < (int) pins.size(); ++i) {
-        auto [x1, y1] = pins[i]->absolute();
-        for (int j = i + 1; j < (int) pins.size(); ++j) {
-            auto [x2, y2] = pins[j]->absolute();
-            ret += abs(x2 - x1) + abs(y2 - y1);
-        }
-    }
-    return ret * cf;
+void TaskSolver::set_cancel(const std::atomic<bool>* flag) {
+    cancel_flag = flag;
 }
 
 std::string my_round(double x, int e) {
@@ -666,8 +453,3 @@ std::string my_round(double x, int e) {
     sprintf(buffer, format.c_str(), x);
     return buffer;
 }
-
-Point Pin::absolute() const {
-    return {relative.x + assigned_device->center.x,
-            relative.y + assigned_device->center.y};
-}
\ No newline at end of file
@@ -6,12 +6,19 @@
 #ifndef PYBIND11_ALGO_TASKSOLVER_H
 #define PYBIND11_ALGO_TASKSOLVER_H
 
+#include <atomic>
 #include <map>
 #include <vector>
 #include <string>
 
 #include <pybind11/pybind11.h>
 
+#include "Layout.h"
+#include "LayoutIO.h"
+#include "Metrics.h"
+#include "NetModel.h"
+#include "WirelengthTracker.h"
+
 namespace py = pybind11;
 
 void get_value(const py::kwargs& kwargs, const std::string& name, int& val, int def);
@@ -20,6 +27,8 @@ void get_value_double(const py::kwargs& kwargs, const std::string& name, double&
 
 void get_value_nodef(const py::kwargs& kwargs, const std::string& name, int& val);
 
+void get_value_str(const py::kwargs& kwargs, const std::string& name, std::string& val, const std::string& def);
+
 template<typename T>
 T gcd(T a, T b) {
     if (a == 0)
@@ -35,53 +44,6 @@ struct Param {
 
 using Params = std::vector<Param>;
 
-struct Point {
-    int x, y;
-};
-
-struct Pin;
-
-struct Device {
-    int id;
-    int half_width;
-    int half_height;
-    Point center;
-    std::vector<Pin*> pins;
-};
-
-struct Pin {
-    int id;
-    int half_width;
-    int half_height;
-    Device* assigned_device;
-    Point relative;
-
-    [[nodiscard]] Point absolute() const;
-};
-
-struct Net {
-    int id;
-    std::vector<Pin*> pins;
-};
-
-struct Layout {
-    Device* devices{nullptr};
-    Pin* pins{nullptr};
-    Net* nets{nullptr};
-
-    int device_cnt{0};
-    int pin_cnt{0};
-    int net_cnt{0};
-
-    int bbox_width{0};
-    int bbox_height{0};
-}; 
-
-void destroy_layout(Layout& layout);
-
-Layout init_layout_from_file(const std::string& input_path);
-void write_layout_to_file(const std::string& output_path, const Layout& layout);
-
 Point get_offset(int width, int height, int step_x, int step_y, int rows, int cols, int device_hwidth, int device_hheight);
 
 Layout random_layout(
@@ -128,34 +90,66 @@ public:
 
     static double get_cpu(int start);
 
-    double calc_metric(std::function<double(const Net*)>&& metric) const;
+    // total manhattan clique wirelength of the current placement
+    [[nodiscard]] double calc_twl() const;
+
+    // requested TWL metrics of the current placement, computed in one pass
+    void add_metrics(Params& p) const;
 
-    void add_debug_info(Params& p, double t, std::function<double(const Net*)>&& metric) const;
+    // snapshot at time t, twl usually comes from a WirelengthTracker
+    void add_debug_info(Params& p, double t, double twl) const;
+
+    // flag of this solve, raised by placer.cancel possibly from another thread: solve() stops early and
+    // still writes and returns its best placement so far. Null, the default, for none
+    void set_cancel(const std::atomic<bool>* flag);
 
 protected:
     void init_layout(const std::string& path_to_layout);
     void write_layout(const std::string& path_to_file);
 
-    Device* devices{nullptr};
-    Pin* pins{nullptr};
-    Net* nets{nullptr};
+    // loads layout, remembers output path and reads kwargs common for all solvers
+    void init_common(const py::str& input_path, const py::str& output_path, const py::kwargs& kwargs);
+    // full layout or placement sidecar to output_layout_path, by placement_only
+    void write_output();
+    // throws unless peak bytes, as predicted by MemoryBudget.h, fit into the memory budget
+    void check_memory(double peak) const;
+    // peak bytes as the "Peak memory" estimate
+    void add_peak_memory(Params& p, double peak) const;
+    // solver arrays with the current screen size as bbox
+    [[nodiscard]] LayoutView current_layout() const;
+
+    LayoutArrays layout;
 
     int device_count{0};
     int pin_count{0};
     int net_count{0};
 
     const double DEFAULT_DEBUG_T = -1.0;
+    const int DEFAULT_PLACEMENT_ONLY = 0;
+    const std::string DEFAULT_METRICS{"all"};
+    const int DEFAULT_THREADS = 1;
+    const std::string DEFAULT_NET_MODEL{"clique"};
+    const std::string DEFAULT_COST_CACHE{""};
+    const int DEFAULT_MEMORY_BUDGET = 0;
 
     int screen_width{1280-360};
     int screen_height{720-100};
     int margin_x{30};
     int margin_y{30};
     double debug_t{DEFAULT_DEBUG_T};
-
+    int placement_only{DEFAULT_PLACEMENT_ONLY};
+    unsigned metrics{METRIC_ALL};
+    int threads{DEFAULT_THREADS}; // for metrics, cost tensors and zd restarts, 0 means all hardware threads
+    NetModel net_model{NetModel::clique}; // how the grid solvers split nets into pin pairs
+    std::string cost_cache{DEFAULT_COST_CACHE}; // directory of cached cost models, see CostCache.h, empty for none
+    double memory_budget{0}; // bytes, the kwarg is in MB and 0 means the physical memory
 
     std::string output_layout_path{};
 
+    const std::atomic<bool>* cancel_flag{nullptr};
+
     std::string expect_time{"Expect time"};
+    std::string peak_memory{"Peak memory"};
     std::string CPU_time{"CPU time"};
 
     std::string TWL_manhattan{"TWL manh"};
@@ -170,14 +164,15 @@ protected:
     std::string step_y_name{"step_y"};
 
     std::string debug_t_name{"debug_t"};
+    std::string placement_only_name{"placement_only"};
+    std::string metrics_name{"metrics"};
+    std::string threads_name{"threads"};
+    std::string net_model_name{"net_model"};
+    std::string cost_cache_name{"cost_cache"};
+    std::string memory_budget_name{"memory_budget"};
 
 };
 
-double calc_half_p(const Net* net);
-double calc_clique(const Net* net);
-double calc_hybrid(const Net* net);
-double calc_manhattan(const Net* net);
-
 std::string my_round(double x, int e = 2);
 
 #endif //PYBIND11_ALGO_TASKSOLVER_H
@@ -0,0 +1,144 @@
+#include "WirelengthTracker.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+WirelengthTracker::WirelengthTracker(const LayoutView& layout)
+: layout{layout},
+  device_net_start(layout.device_count + 1, 0),
+  pair_sum(layout.net_count, 0),
+  perimeter(layout.net_count, 0),
+  size_class(layout.net_count, 0) {
+
+    // net sizes are the class keys, classes go in size order
+    std::vector<int> sizes;
+    int max_size = 0;
+    for (int net = 0; net < layout.net_count; ++net) {
+        sizes.push_back(layout.net_size(net));
+        max_size = std::max(max_size, layout.net_size(net));
+    }
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    for (int size : sizes) {
+        class_cf.push_back(size <= 1 ? 0.0 : 1.0 / static_cast<double>(size - 1));
+    }
+    class_sum.assign(sizes.size(), 0);
+    for (int net = 0; net < layout.net_count; ++net) {
+        size_class[net] = (int) (std::lower_bound(sizes.begin(), sizes.end(), layout.net_size(net)) - sizes.begin());
+    }
+
+    // device -> nets, a device with several pins in a net gets it once
+    std::vector<int> last_net(layout.device_count, -1);
+    for (int net = 0; net < layout.net_count; ++net) {
+        for (int i = layout.net_start[net]; i < layout.net_start[net + 1]; ++i) {
+            int device = layout.pin_device[layout.net_pins[i]];
+            if (last_net[device] != net) {
+                last_net[device] = net;
+                ++device_net_start[device + 1];
+            }
+        }
+    }
+    for (int device = 0; device < layout.device_count; ++device) {
+        device_net_start[device + 1] += device_net_start[device];
+    }
+    device_nets.resize(device_net_start[layout.device_count]);
+    std::vector<int> pos(device_net_start.begin(), device_net_start.end() - 1);
+    std::fill(last_net.begin(), last_net.end(), -1);
+    for (int net = 0; net < layout.net_count; ++net) {
+        for (int i = layout.net_start[net]; i < layout.net_start[net + 1]; ++i) {
+            int device = layout.pin_device[layout.net_pins[i]];
+            if (last_net[device] != net) {
+                last_net[device] = net;
+                device_nets[pos[device]++] = net;
+            }
+        }
+    }
+
+    xs.resize(max_size);
+    ys.resize(max_size);
+    scratch.resize(max_size);
+    reset();
+}
+
+int WirelengthTracker::gather(int net) {
+    int size = layout.net_size(net);
+    const int* pins = layout.net_pins + layout.net_start[net];
+    for (int i = 0; i < size; ++i) {
+        xs[i] = layout.pin_abs_x(pins[i]);
+        ys[i] = layout.pin_abs_y(pins[i]);
+    }
+    return size;
+}
+
+void WirelengthTracker::reset() {
+    const MetricKernels& kernels = metric_kernels();
+    std::fill(class_sum.begin(), class_sum.end(), 0);
+    perimeter_sum = 0;
+    for (int net = 0; net < layout.net_count; ++net) {
+        int size = gather(net);
+        pair_sum[net] = net_pair_manhattan_best(kernels, xs.data(), ys.data(), size, scratch.data());
+        perimeter[net] = static_cast<long long>(2 * net_half_p(xs.data(), ys.data(), size));
+        class_sum[size_class[net]] += pair_sum[net];
+        perimeter_sum += perimeter[net];
+    }
+}
+
+void WirelengthTracker::update_net(int net, int device, int dx, int dy) {
+    int size = gather(net);
+    const int* pins = layout.net_pins + layout.net_start[net];
+
+    // pairs inside the device keep their distance, only pairs with one moved pin change
+    long long delta = 0;
+    for (int i = 0; i < size; ++i) {
+        if (layout.pin_device[pins[i]] != device) {
+            continue;
+        }
+        int old_x = xs[i] - dx;
+        int old_y = ys[i] - dy;
+        for (int j = 0; j < size; ++j) {
+            if (layout.pin_device[pins[j]] == device) {
+                continue;
+            }
+            delta += std::abs(xs[i] - xs[j]) - std::abs(old_x - xs[j])
+                   + std::abs(ys[i] - ys[j]) - std::abs(old_y - ys[j]);
+        }
+    }
+    pair_sum[net] += delta;
+    class_sum[size_class[net]] += delta;
+
+    long long new_perimeter = static_cast<long long>(2 * net_half_p(xs.data(), ys.data(), size));
+    perimeter_sum += new_perimeter - perimeter[net];
+    perimeter[net] = new_perimeter;
+}
+
+void WirelengthTracker::move(int device, Point to) {
+    int dx = to.x - layout.center_x[device];
+    int dy = to.y - layout.center_y[device];
+    if (dx == 0 && dy == 0) {
+        return;
+    }
+    layout.set_center(device, to);
+    for (int i = device_net_start[device]; i < device_net_start[device + 1]; ++i) {
+        update_net(device_nets[i], device, dx, dy);
+    }
+}
+
+void WirelengthTracker::swap(int a, int b) {
+    Point center_a = layout.center(a);
+    Point center_b = layout.center(b);
+    move(a, center_b);
+    move(b, center_a);
+}
+
+double WirelengthTracker::manhattan() const {
+    double ret = 0;
+    for (int c = 0; c < (int) class_sum.size(); ++c) {
+        ret += static_cast<double>(class_sum[c]) * class_cf[c];
+    }
+    return ret;
+}
+
+double WirelengthTracker::half_p() const {
+    return static_cast<double>(perimeter_sum) / 2.0;
+}
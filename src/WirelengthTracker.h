@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Layout.h"
+
+#include <vector>
+
+// Manhattan clique and half-perimeter wirelength of a layout kept up to date while devices move.
+// Moves go through the tracker, which sets the device center in the layout and updates only
+// the nets of that device: O(pins of the net * pins of the device in it) per net.
+// Pair sums are kept exactly in integers, the totals are summed per net size class,
+// so manhattan() may differ from calc_twl() in the last bits.
+class WirelengthTracker {
+public:
+    // reads the current centers, the layout arrays must outlive the tracker
+    explicit WirelengthTracker(const LayoutView& layout);
+
+    // recomputes every net from the current centers, after centers were changed directly
+    void reset();
+
+    void move(int device, Point to);
+    void swap(int a, int b);
+
+    [[nodiscard]] double manhattan() const;
+    [[nodiscard]] double half_p() const;
+
+private:
+    void update_net(int net, int device, int dx, int dy);
+    int gather(int net);
+
+    LayoutView layout;
+
+    // CSR device -> nets, every net once per device
+    std::vector<int> device_net_start;
+    std::vector<int> device_nets;
+
+    std::vector<long long> pair_sum; // per net, not normalized
+    std::vector<long long> perimeter; // per net, width + height of the pin bounding box
+    std::vector<int> size_class; // per net, index in class_sum
+
+    std::vector<long long> class_sum; // pair sums of nets with the same size
+    std::vector<double> class_cf; // 1 / (size - 1) of the class
+    long long perimeter_sum{0};
+
+    std::vector<int> xs, ys, scratch;
+};
@@ -0,0 +1,147 @@
+// Goto swap delta benchmark: the seven dense n x n coefficient arrays the engine used before
+// vs its packed per-pair records, on a random sparse connectivity over a rows x cols grid.
+// usage: bench_goto_delta [rows] [cols] [degree] [swaps]
+
+#include "../algo/goto.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+    // about degree / 2 random partners per device, terms as a layout with pins inside devices gives them
+    ConnectivityModel random_model(int devices, int degree, std::mt19937& rnd) {
+        std::vector<ConnectivityModel::Record> records;
+        for (int a = 0; a < devices; ++a) {
+            for (int q = 0; q < degree / 2; ++q) {
+                int b = (int) (rnd() % devices);
+                if (a == b) {
+                    continue;
+                }
+                long long mul = (long long) (rnd() % 4) + 1;
+                long long left = (long long) (rnd() % 41) - 20;
+                long long up = (long long) (rnd() % 41) - 20;
+                long long same_x = std::abs(left) + (long long) (rnd() % 10);
+                long long same_y = std::abs(up) + (long long) (rnd() % 10);
+                records.push_back({std::min(a, b), std::max(a, b), {mul, left, same_x, mul, up, same_y}});
+            }
+        }
+        return ConnectivityModel::from_records(devices, std::move(records));
+    }
+
+    // the layout GotoHeurist had: seven slots x slots arrays and a branch per axis
+    struct DenseArrays {
+        int devices;
+        std::vector<long long> w, left_x, same_x, right_x, up_y, same_y, down_y;
+        std::vector<int> loc_x, loc_y;
+        const ConnectivityModel& model;
+
+        DenseArrays(int rows, int cols, int step, const ConnectivityModel& model_)
+                : devices{rows * cols}, model{model_} {
+            size_t n2 = (size_t) devices * devices;
+            for (auto* a : {&w, &left_x, &same_x, &right_x, &up_y, &same_y, &down_y}) {
+                a->assign(n2, 0);
+            }
+            for (int i = 0; i < devices; ++i) {
+                for (int e = model.start[i]; e < model.start[i + 1]; ++e) {
+                    int j = model.neighbor[e];
+                    const PairTerms& t = model.terms[e];
+                    size_t q = (size_t) i * devices + j;
+                    size_t r = (size_t) j * devices + i;
+                    left_x[q] = t.left;
+                    same_x[q] = t.same_x;
+                    right_x[r] = t.left;
+                    up_y[q] = t.up;
+                    same_y[q] = t.same_y;
+                    down_y[r] = t.up;
+                    w[q] = t.mul_x;
+                }
+            }
+            for (int s = 0; s < devices; ++s) {
+                loc_x.push_back(step * (s % cols));
+                loc_y.push_back(step * (s / cols));
+            }
+        }
+
+        long long contrib(int i, int j, int pos_i, int pos_j) const {
+            size_t q = (size_t) i * devices + j;
+            int xi = loc_x[pos_i], xj = loc_x[pos_j], yi = loc_y[pos_i], yj = loc_y[pos_j];
+            return w[q] * std::abs(xi - xj) + (xi == xj ? same_x[q] : (xi < xj ? left_x[q] : right_x[q]))
+                   + w[q] * std::abs(yi - yj) + (yi == yj ? same_y[q] : (yi < yj ? down_y[q] : up_y[q]));
+        }
+
+        long long delta(const std::vector<int>& perm, int i, int j) const {
+            if (i == j) {
+                return 0;
+            }
+            long long ret = 0;
+            int pos_i = perm[i], pos_j = perm[j];
+            for (int e = model.start[i]; e < model.start[i + 1]; ++e) {
+                int q = model.neighbor[e];
+                if (q != j) {
+                    ret += contrib(i, q, pos_j, perm[q]) - contrib(i, q, pos_i, perm[q]);
+                }
+            }
+            for (int e = model.start[j]; e < model.start[j + 1]; ++e) {
+                int q = model.neighbor[e];
+                if (q != i) {
+                    ret += contrib(j, q, pos_i, perm[q]) - contrib(j, q, pos_j, perm[q]);
+                }
+            }
+            return ret + contrib(i, j, pos_j, pos_i) - contrib(i, j, pos_i, pos_j);
+        }
+    };
+
+    template<typename Delta>
+    double seconds(Delta delta, const std::vector<std::pair<int, int>>& swaps, long long& sum) {
+        auto start = std::chrono::steady_clock::now();
+        sum = 0;
+        for (auto [i, j] : swaps) {
+            sum += delta(i, j);
+        }
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(finish - start).count();
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 30;
+    int cols = argc > 2 ? atoi(argv[2]) : 30;
+    int degree = argc > 3 ? atoi(argv[3]) : 8;
+    int swap_count = argc > 4 ? atoi(argv[4]) : 2000000;
+    int step = 70;
+    int devices = rows * cols;
+
+    std::mt19937 rnd(7);
+    ConnectivityModel model = random_model(devices, degree, rnd);
+
+    std::vector<int> perm(devices);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::shuffle(perm.begin(), perm.end(), rnd);
+    std::vector<std::pair<int, int>> swaps(swap_count);
+    for (auto& [i, j] : swaps) {
+        i = (int) (rnd() % devices);
+        j = (int) (rnd() % devices);
+    }
+
+    DenseArrays dense(rows, cols, step, model);
+    Goto::GotoHeurist packed(rows, cols, step, step, model);
+
+    long long dense_sum, packed_sum;
+    double dense_time = seconds([&](int i, int j) { return dense.delta(perm, i, j); }, swaps, dense_sum);
+    double packed_time = seconds([&](int i, int j) { return packed.swap_delta(perm, i, j); }, swaps, packed_sum);
+
+    printf("%dx%d grid, %d pairs sharing a net, %d swaps\n", rows, cols, model.edges() / 2, swap_count);
+    printf("  dense arrays   %8.1f ns/delta  %7.1f MB\n", dense_time / swap_count * 1e9,
+           7.0 * devices * devices * sizeof(long long) / (1 << 20));
+    printf("  packed records %8.1f ns/delta  %7.1f MB  speedup %5.2fx  %s\n", packed_time / swap_count * 1e9,
+           (double) model.edges() / 2 * 64 / (1 << 20), dense_time / packed_time,
+           dense_sum == packed_sum ? "match" : "DIFFER");
+    return 0;
+}
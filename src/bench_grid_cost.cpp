@@ -0,0 +1,144 @@
+// Cost tensor construction benchmark: the per-location-pair loop the ZD solver used before
+// vs build_cost_tensor on one and on all hardware threads, on a random layout over a rows x cols grid.
+// usage: bench_grid_cost [rows] [cols] [nets] [repeats]
+
+#include "GridCost.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // 1-4 pins per device with offsets inside the device, nets of 2-6 pins
+    LayoutArrays random_layout(int devices, int net_count, std::mt19937& rnd) {
+        std::vector<int> device_pins(devices);
+        int pins = 0;
+        for (int i = 0; i < devices; ++i) {
+            device_pins[i] = (int) (rnd() % 4) + 1;
+            pins += device_pins[i];
+        }
+        std::vector<int> sizes(net_count);
+        int net_pins = 0;
+        for (int i = 0; i < net_count; ++i) {
+            sizes[i] = (int) (rnd() % 5) + 2;
+            net_pins += sizes[i];
+        }
+
+        LayoutArrays layout = allocate_layout_arrays(devices, pins, net_count, net_pins);
+        int pin = 0;
+        for (int i = 0; i < devices; ++i) {
+            layout.center_x[i] = 0;
+            layout.center_y[i] = 0;
+            for (int j = 0; j < device_pins[i]; ++j, ++pin) {
+                layout.pin_device[pin] = i;
+                layout.pin_x[pin] = (int) (rnd() % 41) - 20;
+                layout.pin_y[pin] = (int) (rnd() % 41) - 20;
+            }
+        }
+        layout.net_start[0] = 0;
+        for (int i = 0; i < net_count; ++i) {
+            for (int j = 0; j < sizes[i]; ++j) {
+                layout.net_pins[layout.net_start[i] + j] = (int) (rnd() % pins);
+            }
+            layout.net_start[i + 1] = layout.net_start[i] + sizes[i];
+        }
+        return layout;
+    }
+
+    // the loop zdTaskSolver used: every pin pair of every net times every pair of locations
+    CostTensor reference_cost_tensor(const LayoutView& layout, long long lcm, const std::vector<Point>& locations) {
+        int n = layout.device_count;
+        CostTensor cost(n);
+        for (int n_id = 0; n_id < layout.net_count; ++n_id) {
+            const int* cur_pin = layout.net_pins + layout.net_start[n_id];
+            int size = layout.net_size(n_id);
+            if (size <= 1) {
+                continue;
+            }
+            int w = lcm / (size - 1);
+            for (int i = 0; i < size; ++i) {
+                for (int j = 0; j < size; ++j) {
+                    int a = cur_pin[i];
+                    int b = cur_pin[j];
+                    int da = layout.pin_device[a];
+                    int db = layout.pin_device[b];
+                    if (i == j || da == db) {
+                        continue;
+                    }
+                    for (int p1 = 0; p1 < (int) locations.size(); ++p1) {
+                        Point pos_a{locations[p1].x + layout.pin_x[a], locations[p1].y + layout.pin_y[a]};
+                        for (int p2 = 0; p2 < (int) locations.size(); ++p2) {
+                            if (p1 == p2) {
+                                continue;
+                            }
+                            Point pos_b{locations[p2].x + layout.pin_x[b], locations[p2].y + layout.pin_y[b]};
+                            int dist = abs(pos_a.x - pos_b.x) + abs(pos_a.y - pos_b.y);
+                            cost.at(da, db, p1, p2) += 1ll * w * dist;
+                        }
+                    }
+                }
+            }
+        }
+        return cost;
+    }
+
+    template<typename Build>
+    double best_seconds(Build build, int repeats, CostTensor& result) {
+        double best = 1e18;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            result = build();
+            auto finish = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(finish - start).count());
+        }
+        return best;
+    }
+
+    bool same(const CostTensor& a, const CostTensor& b) {
+        return std::memcmp(a.data(), b.data(), a.entries() * sizeof(long long)) == 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 6;
+    int cols = argc > 2 ? atoi(argv[2]) : 6;
+    int nets = argc > 3 ? atoi(argv[3]) : 3 * rows * cols;
+    int repeats = argc > 4 ? atoi(argv[4]) : 3;
+    int step_x = 70, step_y = 70;
+
+    std::mt19937 rnd(7);
+    LayoutArrays layout = random_layout(rows * cols, nets, rnd);
+    long long lcm = NET_WEIGHT_SCALE; // nets of 2-6 pins, clique weights are exact
+
+    std::vector<Point> locations;
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            locations.push_back({j * step_x, i * step_y});
+        }
+    }
+
+    CostTensor reference, serial, threaded;
+    double reference_time = best_seconds([&] { return reference_cost_tensor(layout, lcm, locations); },
+                                         repeats, reference);
+    double serial_time = best_seconds([&] {
+        return build_cost_tensor(layout, NetModel::clique, rows, cols, step_x, step_y, 1);
+    }, repeats, serial);
+    double threaded_time = best_seconds([&] {
+        return build_cost_tensor(layout, NetModel::clique, rows, cols, step_x, step_y, 0);
+    }, repeats, threaded);
+
+    printf("%dx%d grid, %d nets, tensor %.1f MB\n", rows, cols, nets,
+           (double) reference.entries() * sizeof(long long) / (1 << 20));
+    printf("  reference  %8.4f s\n", reference_time);
+    printf("  1 thread   %8.4f s  speedup %6.2fx  %s\n", serial_time, reference_time / serial_time,
+           same(reference, serial) ? "match" : "DIFFER");
+    printf("  %u threads %8.4f s  speedup %6.2fx  %s\n", std::thread::hardware_concurrency(), threaded_time,
+           reference_time / threaded_time, same(reference, threaded) ? "match" : "DIFFER");
+    return 0;
+}
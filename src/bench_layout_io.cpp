@@ -0,0 +1,255 @@
+// Layout I/O benchmark: fscanf loader vs load_layout_arrays on text and binary files,
+// fprintf writer vs write_layout_to_file and the placement sidecar.
+// usage: bench_layout_io [device_count] [pins_per_device] [repeats]
+
+#include "Layout.h"
+#include "LayoutIO.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <sys/stat.h>
+
+namespace {
+
+    Layout random_layout(int device_count, int pins_per_device, std::mt19937& rnd) {
+        Layout layout;
+        layout.device_cnt = device_count;
+        layout.pin_cnt = device_count * pins_per_device;
+        layout.net_cnt = layout.pin_cnt / 4;
+        layout.devices = new Device[layout.device_cnt];
+        layout.pins = new Pin[layout.pin_cnt];
+        layout.nets = new Net[layout.net_cnt];
+        layout.bbox_width = 100000;
+        layout.bbox_height = 100000;
+        for (int i = 0; i < layout.device_cnt; ++i) {
+            layout.devices[i].id = i;
+            layout.devices[i].center = {(int) (rnd() % 100000), (int) (rnd() % 100000)};
+            layout.devices[i].half_width = 10 + (int) (rnd() % 200);
+            layout.devices[i].half_height = 10 + (int) (rnd() % 200);
+        }
+        for (int i = 0; i < layout.pin_cnt; ++i) {
+            Device* device = layout.devices + i / pins_per_device;
+            layout.pins[i].id = i;
+            layout.pins[i].assigned_device = device;
+            layout.pins[i].relative = {(int) (rnd() % (2 * device->half_width + 1)) - device->half_width,
+                                       (int) (rnd() % (2 * device->half_height + 1)) - device->half_height};
+            layout.pins[i].half_width = 1 + (int) (rnd() % 5);
+            layout.pins[i].half_height = 1 + (int) (rnd() % 5);
+        }
+        for (int i = 0; i < layout.pin_cnt; ++i) {
+            layout.nets[rnd() % layout.net_cnt].pins.push_back(layout.pins + i);
+        }
+        for (int i = 0; i < layout.net_cnt; ++i) {
+            layout.nets[i].id = i;
+        }
+        return layout;
+    }
+
+    // loader used before init_layout_from_file was rewritten
+    Layout fscanf_layout(const std::string& path) {
+        FILE* file = fopen(path.c_str(), "r");
+        char temp_buffer[1024];
+        Layout layout;
+        fscanf(file, "%s", temp_buffer);
+        fscanf(file, "%d", &layout.device_cnt);
+        layout.devices = new Device[layout.device_cnt];
+        for (int i = 0; i < layout.device_cnt; ++i) {
+            int id;
+            fscanf(file, "%d", &id);
+            Device& d = layout.devices[id];
+            d.id = id;
+            fscanf(file, "%d %d %d %d", &d.center.x, &d.center.y, &d.half_width, &d.half_height);
+        }
+        fscanf(file, "%s", temp_buffer);
+        fscanf(file, "%d", &layout.pin_cnt);
+        layout.pins = new Pin[layout.pin_cnt];
+        for (int i = 0; i < layout.pin_cnt; ++i) {
+            int id, device_id;
+            fscanf(file, "%d %d", &id, &device_id);
+            Pin& p = layout.pins[id];
+            p.id = id;
+            p.assigned_device = layout.devices + device_id;
+            fscanf(file, "%d %d %d %d", &p.relative.x, &p.relative.y, &p.half_width, &p.half_height);
+        }
+        fscanf(file, "%s", temp_buffer);
+        fscanf(file, "%d", &layout.net_cnt);
+        layout.nets = new Net[layout.net_cnt];
+        for (int i = 0; i < layout.net_cnt; ++i) {
+            int id, net_size;
+            fscanf(file, "%d %d", &id, &net_size);
+            layout.nets[id].id = id;
+            layout.nets[id].pins.reserve(net_size);
+            for (int j = 0; j < net_size; ++j) {
+                int pin_id;
+                fscanf(file, "%d", &pin_id);
+                layout.nets[id].pins.push_back(layout.pins + pin_id);
+            }
+        }
+        fscanf(file, "%d %d", &layout.bbox_width, &layout.bbox_height);
+        fclose(file);
+        return layout;
+    }
+
+    // writer used before write_layout_to_file was rewritten
+    void fprintf_layout(const std::string& path, const Layout& layout) {
+        FILE* file = fopen(path.c_str(), "w");
+        fprintf(file, "Devices\n%d\n", layout.device_cnt);
+        for (int i = 0; i < layout.device_cnt; ++i) {
+            const Device& d = layout.devices[i];
+            fprintf(file, "%d\n%d %d %d %d\n", d.id, d.center.x, d.center.y, d.half_width, d.half_height);
+        }
+        fprintf(file, "Pins\n%d\n", layout.pin_cnt);
+        for (int i = 0; i < layout.pin_cnt; ++i) {
+            const Pin& p = layout.pins[i];
+            fprintf(file, "%d\n%d %d %d %d %d\n", p.id, p.assigned_device->id,
+                    p.relative.x, p.relative.y, p.half_width, p.half_height);
+        }
+        fprintf(file, "Nets\n%d\n", layout.net_cnt);
+        for (int i = 0; i < layout.net_cnt; ++i) {
+            int net_size = (int) layout.nets[i].pins.size();
+            fprintf(file, "%d\n%d ", layout.nets[i].id, net_size);
+            for (int j = 0; j < net_size; ++j) {
+                fprintf(file, "%d", layout.nets[i].pins[j]->id);
+                if (j + 1 < net_size) {
+                    fprintf(file, " ");
+                }
+            }
+            fprintf(file, "\n");
+        }
+        fprintf(file, "%d %d\n", layout.bbox_width, layout.bbox_height);
+        fclose(file);
+    }
+
+    template<typename Writer, typename Source>
+    double best_write_seconds(Writer writer, const std::string& path, const Source& layout, int repeats) {
+        double best = 1e18;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            writer(path, layout);
+            auto finish = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(finish - start).count());
+        }
+        return best;
+    }
+
+    double file_mb(const std::string& path) {
+        struct stat st{};
+        stat(path.c_str(), &st);
+        return (double) st.st_size / (1 << 20);
+    }
+
+    bool same_layout(const Layout& a, const Layout& b) {
+        if (a.device_cnt != b.device_cnt || a.pin_cnt != b.pin_cnt || a.net_cnt != b.net_cnt
+        || a.bbox_width != b.bbox_width || a.bbox_height != b.bbox_height) {
+            return false;
+        }
+        for (int i = 0; i < a.device_cnt; ++i) {
+            const Device& x = a.devices[i];
+            const Device& y = b.devices[i];
+            if (x.center.x != y.center.x || x.center.y != y.center.y
+            || x.half_width != y.half_width || x.half_height != y.half_height) {
+                return false;
+            }
+        }
+        for (int i = 0; i < a.pin_cnt; ++i) {
+            const Pin& x = a.pins[i];
+            const Pin& y = b.pins[i];
+            if (x.assigned_device->id != y.assigned_device->id || x.relative.x != y.relative.x
+            || x.relative.y != y.relative.y || x.half_width != y.half_width || x.half_height != y.half_height) {
+                return false;
+            }
+        }
+        for (int i = 0; i < a.net_cnt; ++i) {
+            if (a.nets[i].pins.size() != b.nets[i].pins.size()) {
+                return false;
+            }
+            for (int j = 0; j < (int) a.nets[i].pins.size(); ++j) {
+                if (a.nets[i].pins[j]->id != b.nets[i].pins[j]->id) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template<typename Loader>
+    double best_seconds(Loader loader, const std::string& path, int repeats, Layout& result) {
+        double best = 1e18;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            Layout layout = loader(path);
+            auto finish = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(finish - start).count());
+            destroy_layout(result);
+            result = layout;
+        }
+        return best;
+    }
+
+    double best_arrays_seconds(const std::string& path, int repeats, LayoutArrays& result) {
+        double best = 1e18;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            LayoutArrays arrays = load_layout_arrays(path);
+            auto finish = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(finish - start).count());
+            result = std::move(arrays);
+        }
+        return best;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int device_count = argc > 1 ? atoi(argv[1]) : 200000;
+    int pins_per_device = argc > 2 ? atoi(argv[2]) : 8;
+    int repeats = argc > 3 ? atoi(argv[3]) : 3;
+
+    std::mt19937 rnd(7);
+    Layout layout = random_layout(device_count, pins_per_device, rnd);
+    const std::string path = "bench_layout_io.txt";
+    const std::string placement_path = "bench_layout_io.placement";
+
+    const std::string binary_path = "bench_layout_io.bin";
+    LayoutArrays arrays = to_layout_arrays(layout);
+
+    double old_write = best_write_seconds(fprintf_layout, path, layout, repeats);
+    double new_write = best_write_seconds<void (*)(const std::string&, const LayoutView&)>(
+        write_layout_to_file, path, arrays, repeats);
+    double placement_write = best_write_seconds(write_placement_to_file, placement_path, arrays, repeats);
+    double mb = file_mb(path);
+    printf("file: %d devices, %d pins, %.1f MB, placement %.2f MB\n", device_count, device_count * pins_per_device,
+           mb, file_mb(placement_path));
+    destroy_layout(layout);
+    write_binary_layout(binary_path, arrays);
+
+    Layout old_layout;
+    LayoutArrays text_arrays, binary_arrays;
+    double old_time = best_seconds(fscanf_layout, path, repeats, old_layout);
+    double text_time = best_arrays_seconds(path, repeats, text_arrays);
+    double binary_time = best_arrays_seconds(binary_path, repeats, binary_arrays);
+    Layout text_layout = to_layout(text_arrays);
+    Layout binary_layout = to_layout(binary_arrays);
+    printf("fscanf loader:         %8.3f s %8.1f MB/s\n", old_time, mb / old_time);
+    printf("load_layout_arrays:    %8.3f s %8.1f MB/s\n", text_time, mb / text_time);
+    printf("speedup: %.1fx, results %s\n", old_time / text_time,
+           same_layout(old_layout, text_layout) ? "match" : "DIFFER");
+    printf("binary mapping:        %8.3f s, results %s\n", binary_time,
+           same_layout(old_layout, binary_layout) ? "match" : "DIFFER");
+
+    printf("fprintf writer:        %8.3f s %8.1f MB/s\n", old_write, mb / old_write);
+    printf("write_layout_to_file:  %8.3f s %8.1f MB/s\n", new_write, mb / new_write);
+    printf("placement sidecar:     %8.3f s\n", placement_write);
+
+    destroy_layout(old_layout);
+    destroy_layout(text_layout);
+    destroy_layout(binary_layout);
+    remove(path.c_str());
+    remove(placement_path.c_str());
+    remove(binary_path.c_str());
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Wirelength kernel benchmark: scalar loops vs the kernels picked by metric_kernels()
+// and the sorted manhattan pair sum, on nets of one size with random pin coordinates.
+// Then a whole random layout is evaluated on one and on all hardware threads.
+// usage: bench_metrics [total_pins] [repeats]
+
+#include "Metrics.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    struct Nets {
+        int size;
+        int count;
+        std::vector<int> xs;
+        std::vector<int> ys;
+    };
+
+    Nets random_nets(int size, int total_pins, std::mt19937& rnd) {
+        Nets nets{size, std::max(1, total_pins / size), {}, {}};
+        std::uniform_int_distribution<int> coord(0, 100000);
+        nets.xs.resize((size_t) nets.count * size);
+        nets.ys.resize((size_t) nets.count * size);
+        for (size_t i = 0; i < nets.xs.size(); ++i) {
+            nets.xs[i] = coord(rnd);
+            nets.ys[i] = coord(rnd);
+        }
+        return nets;
+    }
+
+    template<typename Kernel>
+    double best_seconds(Kernel kernel, const Nets& nets, int repeats, double& result) {
+        double best = 1e18;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            double sum = 0;
+            for (int n = 0; n < nets.count; ++n) {
+                size_t at = (size_t) n * nets.size;
+                sum += (double) kernel(nets.xs.data() + at, nets.ys.data() + at, nets.size);
+            }
+            auto finish = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(finish - start).count());
+            result = sum;
+        }
+        return best;
+    }
+
+    void compare(const char* name, const Nets& nets, int repeats, auto scalar, auto fast, bool exact,
+                 const char* fast_name = metric_kernels().name) {
+        double scalar_sum = 0, fast_sum = 0;
+        double scalar_time = best_seconds(scalar, nets, repeats, scalar_sum);
+        double fast_time = best_seconds(fast, nets, repeats, fast_sum);
+        bool match = exact ? scalar_sum == fast_sum
+                           : std::abs(scalar_sum - fast_sum) <= 1e-9 * std::abs(scalar_sum);
+        printf("  %-16s scalar %8.4f s  %-6s %8.4f s  speedup %6.2fx  %s\n", name, scalar_time,
+               fast_name, fast_time, scalar_time / fast_time, match ? "match" : "DIFFER");
+    }
+
+    // nets of 2-6 pins with every 50th net a 200-1000 pin one
+    LayoutArrays random_layout(int net_count, std::mt19937& rnd) {
+        std::vector<int> sizes(net_count);
+        int net_pins = 0;
+        for (int i = 0; i < net_count; ++i) {
+            sizes[i] = i % 50 == 0 ? (int) (rnd() % 801) + 200 : (int) (rnd() % 5) + 2;
+            net_pins += sizes[i];
+        }
+        int devices = std::max(1, net_count / 2);
+        int pins = std::max(1, net_count * 2);
+        LayoutArrays layout = allocate_layout_arrays(devices, pins, net_count, net_pins);
+        for (int i = 0; i < devices; ++i) {
+            layout.center_x[i] = (int) (rnd() % 100000);
+            layout.center_y[i] = (int) (rnd() % 100000);
+        }
+        for (int i = 0; i < pins; ++i) {
+            layout.pin_device[i] = (int) (rnd() % devices);
+            layout.pin_x[i] = (int) (rnd() % 41) - 20;
+            layout.pin_y[i] = (int) (rnd() % 41) - 20;
+        }
+        layout.net_start[0] = 0;
+        for (int i = 0; i < net_count; ++i) {
+            for (int j = 0; j < sizes[i]; ++j) {
+                layout.net_pins[layout.net_start[i] + j] = (int) (rnd() % pins);
+            }
+            layout.net_start[i + 1] = layout.net_start[i] + sizes[i];
+        }
+        return layout;
+    }
+
+    double evaluate_seconds(const LayoutView& layout, int threads, int repeats, MetricTotals& result) {
+        double best = 1e18;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            result = evaluate_metrics(layout, METRIC_ALL, threads);
+            auto finish = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(finish - start).count());
+        }
+        return best;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int total_pins = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    int repeats = argc > 2 ? atoi(argv[2]) : 3;
+
+    const MetricKernels& scalar = scalar_metric_kernels();
+    const MetricKernels& fast = metric_kernels();
+    printf("kernels: %s\n", fast.name);
+
+    std::mt19937 rnd(7);
+    for (int size : {8, 16, 64, 256, 1024, 4096}) {
+        Nets nets = random_nets(size, total_pins, rnd);
+        // pairwise kernels are quadratic, keep their work comparable across sizes
+        Nets pair_nets = random_nets(size, std::max<long long>(size, 32ll * total_pins / size), rnd);
+        printf("net size %d:\n", size);
+        compare("half_p", nets, repeats, scalar.half_p, fast.half_p, true);
+        compare("pair_manhattan", pair_nets, repeats, scalar.pair_manhattan, fast.pair_manhattan, true);
+        std::vector<int> scratch(size);
+        auto sorted = [&scratch](const int* xs, const int* ys, int size) {
+            return net_pair_manhattan_sorted(xs, ys, size, scratch.data());
+        };
+        compare("sorted_manhattan", pair_nets, repeats, scalar.pair_manhattan, sorted, true, "sorted");
+        compare("pair_euclid", pair_nets, repeats, scalar.pair_euclid, fast.pair_euclid, false);
+    }
+
+    LayoutArrays layout = random_layout(100000, rnd);
+    MetricTotals serial, threaded;
+    double serial_time = evaluate_seconds(layout, 1, repeats, serial);
+    double threaded_time = evaluate_seconds(layout, 0, repeats, threaded);
+    bool same = serial.manhattan == threaded.manhattan && serial.half_p == threaded.half_p
+             && serial.clique == threaded.clique && serial.hybrid == threaded.hybrid;
+    printf("layout, %d nets, %d chunks:\n", layout.net_count, (int) metric_chunks(layout).size() - 1);
+    printf("  1 thread %8.4f s  %u threads %8.4f s  speedup %5.2fx  %s\n", serial_time,
+           std::thread::hardware_concurrency(), threaded_time, serial_time / threaded_time,
+           same ? "identical" : "DIFFER");
+    return 0;
+}
@@ -10,7 +10,10 @@ Params bfTaskSolver::get_params() {
             {rows_name, "", false},
             {cols_name, "", false},
             {step_x_name, "", true},
-            {step_y_name, "", true}
+            {step_y_name, "", true},
+            {placement_only_name, std::to_string(DEFAULT_PLACEMENT_ONLY), true},
+            {metrics_name, DEFAULT_METRICS, true},
+            {threads_name, std::to_string(DEFAULT_THREADS), true}
     };
 }
 
@@ -22,7 +25,7 @@ Params bfTaskSolver::estimate() {
 
     long long net_sum = 0;
     for (int i = 0; i < net_count; ++i) {
-        int x = (int) nets[i].pins.size();
+        int x = (int) layout.net_size(i);
         net_sum += 1ll * x * (x - 1) / 2;
     }
 
@@ -55,12 +58,14 @@ Params bfTaskSolver::solve() {
     auto best = perm;
     double best_twl = 1e9;
 
+    // next_permutation changes a suffix, the tracker only updates nets of moved devices
+    WirelengthTracker tracker(layout);
     do {
         for (int i = 0; i < device_count; ++i) {
-            devices[i].center = locations[perm[i]];
+            tracker.move(i, locations[perm[i]]);
         }
 
-        double cur_twl = calc_twl();
+        double cur_twl = tracker.manhattan();
         if (cur_twl < best_twl) {
             best = perm;
             best_twl = cur_twl;
@@ -69,25 +74,22 @@ Params bfTaskSolver::solve() {
     } while (std::next_permutation(perm.begin(), perm.end()));
 
     for (int i = 0; i < device_count; ++i) {
-        devices[i].center = locations[best[i]];
+        layout.set_center(i, locations[best[i]]);
     }
 
-    write_layout(output_layout_path);
+    write_output();
 
     double cpu_time = static_cast<double>(clock() - start) / 1e6;
 
-    return {
+    Params params{
             {CPU_time, my_round(cpu_time, 3) + " sec", false},
-            {TWL_manhattan, my_round(calc_metric(calc_manhattan)), false},
-            {TWL_HP, my_round(calc_metric(calc_half_p)), false},
-            {TWL_clique, my_round(calc_metric(calc_clique)), false},
-            {TWL_hybrid, my_round(calc_metric(calc_hybrid)), false},
     };
+    add_metrics(params);
+    return params;
 }
 
 void bfTaskSolver::init(const py::str &input_path, const py::str &output_path, const py::kwargs &kwargs) {
-    init_layout(input_path.cast<std::string>());
-    output_layout_path = output_path.cast<std::string>();
+    init_common(input_path, output_path, kwargs);
 
     if (!kwargs.contains(rows_name)
     || kwargs[rows_name.c_str()].is_none()
@@ -122,7 +124,7 @@ void bfTaskSolver::init(const py::str &input_path, const py::str &output_path, c
         || kwargs[step_x_name.c_str()].cast<std::string>().empty()) {
             int mx_half_width = (int) -1e8;
             for (int i = 0; i < device_count; ++i) {
-                mx_half_width = std::max(mx_half_width, devices[i].half_width);
+                mx_half_width = std::max(mx_half_width, layout.device_half_width[i]);
             }
 
             step_x = 2 * mx_half_width + margin_x;
@@ -135,7 +137,7 @@ void bfTaskSolver::init(const py::str &input_path, const py::str &output_path, c
         || kwargs[step_y_name.c_str()].cast<std::string>().empty()) {
             int mx_half_height = (int) -1e8;
             for (int i = 0; i < device_count; ++i) {
-                mx_half_height = std::max(mx_half_height, devices[i].half_height);
+                mx_half_height = std::max(mx_half_height, layout.device_half_height[i]);
             }
 
             step_y = 2 * mx_half_height + margin_y;
@@ -147,7 +149,3 @@ void bfTaskSolver::init(const py::str &input_path, const py::str &output_path, c
         throw std::runtime_error("Cant get " + step_x_name + " or " + step_y_name);
     }
 }
-
-double bfTaskSolver::calc_twl() const {
-    return calc_metric(calc_manhattan);
-}
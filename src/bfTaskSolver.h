@@ -22,8 +22,6 @@ private:
     int cols;
     int step_x;
     int step_y;
-
-    [[nodiscard]] double calc_twl() const;
 };
 
 
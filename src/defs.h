@@ -28,6 +28,24 @@ py::list solve(const py::str& solver_name,
                const py::str& output_path,
                const py::kwargs& kwargs);
 
+// a token to pass to solve as cancel_token=..., it serves that one solve; see release_cancel_token
+int cancel_token();
+
+// stops the solve of token, possibly from another thread, even before it started. The solve returns
+// its best placement so far. False when the token is unknown or its solve has ended
+bool cancel(int token);
+
+// forgets a token that will not be passed to solve, tokens are otherwise kept until their solve ends.
+// The token of a running solve stays until that solve ends. False when the token is unknown
+bool release_cancel_token(int token);
+
+py::list convert_layout(const py::str& input_path,
+                        const py::str& output_path);
+
+py::list apply_placement(const py::str& layout_path,
+                         const py::str& placement_path,
+                         const py::str& output_path);
+
 py::list gen_cluster_layout(
                     const std::string& path,
                     int seed,
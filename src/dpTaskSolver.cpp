@@ -1,12 +1,19 @@
 #include "dpTaskSolver.h"
 #include "../algo/dp.h"
+#include "CostCache.h"
+#include "MemoryBudget.h"
 #include <algorithm>
 #include <cmath>
 #include <numeric>
 
 Params dpTaskSolver::get_params() {
     return {
-        {step_x_name, std::to_string(DEFAULT_STEP_X), true}
+        {step_x_name, std::to_string(DEFAULT_STEP_X), true},
+        {placement_only_name, std::to_string(DEFAULT_PLACEMENT_ONLY), true},
+        {metrics_name, DEFAULT_METRICS, true},
+        {threads_name, std::to_string(DEFAULT_THREADS), true},
+        {net_model_name, DEFAULT_NET_MODEL, true},
+        {cost_cache_name, DEFAULT_COST_CACHE, true}
     };
 }
 
@@ -19,55 +26,30 @@ Params dpTaskSolver::estimate() {
     n2 *= device_count * device_count;
 
     double expect_time_result = static_cast<double>(n2) / 1e8;
-    return {
+    Params params{
         {expect_time, my_round(expect_time_result, 3) + " sec", false}
     };
+    add_peak_memory(params, peak_memory_bytes());
+    return params;
 }
 
-int dpTaskSolver::get_lcm() const {
-    long long LCM = 1;
-    const int maxLCM = 1e9;
-
-    for (int n_id = 0; n_id < net_count; ++n_id) {
-        int size = nets[n_id].pins.size();
-        if (size <= 1) {
-            continue;
-        }
-        LCM = 1ll * LCM * (size - 1) / gcd(LCM, (long long)(size - 1));
-        if (LCM > maxLCM) {
-            throw std::runtime_error("Too big nets");
-        }
-    }
-    return (int) LCM;
+double dpTaskSolver::peak_memory_bytes() const {
+    // dp and parent over all 2^n subsets, mut and add both as vectors and in the solver
+    double subsets = std::exp2(device_count) * (sizeof(ans_t) + sizeof(int));
+    double matrices = 4.0 * device_count * device_count * sizeof(ans_t);
+    return subsets + matrices + connectivity_peak_bytes(layout, net_model);
 }
 
-std::pair<mut_t, pin_add_t> dpTaskSolver::get_input(int LCM) const {
+std::pair<mut_t, pin_add_t> dpTaskSolver::get_input() const {
     mut_t mut(n, std::vector<ans_t>(n, 0));
     pin_add_t add(n, std::vector<ans_t>(n, 0));
 
-    for (int n_id = 0; n_id < net_count; ++n_id) {
-        Net* cur_net = nets + n_id;
-        auto cur_pin = cur_net->pins;
-        int size = cur_pin.size();
-        if (size <= 1) {
-            continue;
-        }
-        int w = LCM / (size - 1);
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-
-                Pin *a = cur_pin[i];
-                Pin *b = cur_pin[j];
-                if (a->assigned_device->id == b->assigned_device->id) {
-                    continue;
-                }
-
-                int d1 = a->relative.x;
-                int d2 = b->relative.x;
-
-                add[a->assigned_device->id][b->assigned_device->id] += w * (d2 - d1);
-                mut[a->assigned_device->id][b->assigned_device->id] += w;
-            }
+    ConnectivityModel model = cached_connectivity(cost_cache, layout, net_model);
+    for (int a = 0; a < model.devices; ++a) {
+        for (int e = model.start[a]; e < model.start[a + 1]; ++e) {
+            int b = model.neighbor[e];
+            add[a][b] = model.terms[e].left;
+            mut[a][b] = model.terms[e].mul_x;
         }
     }
 
@@ -81,36 +63,36 @@ Params dpTaskSolver::solve() {
         locations[i] = offset.x + step_x * i;
     }
 
-    auto [mut, add] = get_input(get_lcm());
+    auto [mut, add] = get_input();
 
     SolverDP solver(locations, mut, add);
     auto start = clock();
     auto best = solver.solve();
     for (int i = 0; i < n; ++i) {
-        devices[best[i]].center = {locations[i], offset.y};
+        layout.set_center(best[i], {locations[i], offset.y});
     }
 
     double elapsed_cpu = static_cast<double>(clock() - start) / 1e6;
 
-    write_layout(output_layout_path);
+    write_output();
 
-    return {
+    Params params{
         {CPU_time, my_round(elapsed_cpu, 3) + " sec", false},
-        {TWL_manhattan, my_round(calc_metric(calc_manhattan)), false},
-        {TWL_HP, my_round(calc_metric(calc_half_p)), false},
-        {TWL_clique, my_round(calc_metric(calc_clique)), false},
-        {TWL_hybrid, my_round(calc_metric(calc_hybrid)), false},
     };
+    add_metrics(params);
+    return params;
 }
 
 void dpTaskSolver::init(const py::str& input_path,
               const py::str& output_path,
               const py::kwargs& kwargs) {
     
-    init_layout(input_path.cast<std::string>());
-    output_layout_path = output_path.cast<std::string>();
+    init_common(input_path, output_path, kwargs);
 
     n = device_count;
 
     get_value(kwargs, step_x_name, step_x, DEFAULT_STEP_X);
+
+    // there is no smaller exact mode, a DP over the budget is refused
+    check_memory(peak_memory_bytes());
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ private:
 
     int n;
 
-    int get_lcm() const;
-    std::pair<mut_t, pin_add_t> get_input(int LCM) const;
+    std::pair<mut_t, pin_add_t> get_input() const;
+
+    // see MemoryBudget.h
+    [[nodiscard]] double peak_memory_bytes() const;
 };
\ No newline at end of file
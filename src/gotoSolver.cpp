@@ -4,6 +4,8 @@
 //
 
 #include "gotoSolver.h"
+#include "CostCache.h"
+#include "MemoryBudget.h"
 
 #include "../algo/goto.h"
 
@@ -22,19 +24,25 @@ Params GotoTaskSolver::get_params() {
             {lambda_name, std::to_string(DEFAULT_LAMBDA), true},
             {eps_name, std::to_string(DEFAULT_EPS), true},
             {debug_t_name, std::to_string(DEFAULT_DEBUG_T), true},
-            {defaults_name, std::to_string(DEFAULT_DEFAULTS), true}
+            {defaults_name, std::to_string(DEFAULT_DEFAULTS), true},
+            {placement_only_name, std::to_string(DEFAULT_PLACEMENT_ONLY), true},
+            {metrics_name, DEFAULT_METRICS, true},
+            {threads_name, std::to_string(DEFAULT_THREADS), true},
+            {net_model_name, DEFAULT_NET_MODEL, true},
+            {cost_cache_name, DEFAULT_COST_CACHE, true}
     };
 }
 
 Params GotoTaskSolver::estimate() {
-    return {
+    Params params{
             {expect_time, my_round(time, 3) + " sec", false}
     };
+    add_peak_memory(params, goto_engine_peak_bytes(layout, net_model, eps));
+    return params;
 }
 
 void GotoTaskSolver::init(const py::str &input_path, const py::str &output_path, const py::kwargs &kwargs) {
-    init_layout(input_path.cast<std::string>());
-    output_layout_path = output_path.cast<std::string>();
+    init_common(input_path, output_path, kwargs);
 
     get_value_nodef(kwargs, rows_name, rows);
     get_value_nodef(kwargs, cols_name, cols);
@@ -52,57 +60,14 @@ void GotoTaskSolver::init(const py::str &input_path, const py::str &output_path,
     get_value_double(kwargs, debug_t_name, debug_t, DEFAULT_DEBUG_T);
 
     get_value(kwargs, defaults_name, defaults, DEFAULT_DEFAULTS);
+
+    check_memory(goto_engine_peak_bytes(layout, net_model, eps));
 }
 
 Params GotoTaskSolver::solve() {
 
-    pin_acc_t left(device_count, std::vector<ans_t>(device_count, 0ll));
-    pin_acc_t same_x(device_count, std::vector<ans_t>(device_count, 0ll));
-
-    pin_acc_t up(device_count, std::vector<ans_t>(device_count, 0ll));
-    pin_acc_t same_y(device_count, std::vector<ans_t>(device_count, 0ll));
-
-    mul_t mul(device_count, std::vector<ans_t>(device_count, 0ll));
-
-    long long LCM = 1;
-    const int maxLCM = 1e9;
-
-    for (int n_id = 0; n_id < net_count; ++n_id) {
-        int size = (int) nets[n_id].pins.size();
-        if (size <= 1) {
-            continue;
-        }
-        LCM = 1ll * LCM * (size - 1) / gcd(LCM, 1ll * size - 1);
-        if (LCM > maxLCM) {
-            throw std::runtime_error("Too big nets");
-        }
-    }
-
-    for (int n_id = 0; n_id < net_count; ++n_id) {
-        int size = (int) nets[n_id].pins.size();
-        long long coef = LCM / (size - 1);
-        auto pins = nets[n_id].pins;
-        for (int i = 0; i < (int) pins.size(); ++i) {
-            Device* da = pins[i]->assigned_device;
-            for (int j = 0; j < (int) pins.size(); ++j) {
-                Device* db = pins[j]->assigned_device;
-                if (da->id == db->id) {
-                    continue;
-                }
-
-                mul[da->id][db->id] += coef;
-
-                same_x[da->id][db->id] += coef * abs(pins[i]->relative.x - pins[j]->relative.x);
-                same_y[da->id][db->id] += coef * abs(pins[i]->relative.y - pins[j]->relative.y);
-
-                left[da->id][db->id] += coef * (-pins[i]->relative.x + pins[j]->relative.x);
-                up[da->id][db->id] += coef * (pins[i]->relative.y - pins[j]->relative.y);
-            }
-        }
-    }
-
-
-    GotoHeurist solver(rows, cols, step_x, step_y, left, same_x, up, same_y, mul);
+    GotoHeurist solver(rows, cols, step_x, step_y, cached_connectivity(cost_cache, layout, net_model));
+    solver.set_cancel(cancel_flag);
     if (defaults) {
         config_defaults();
     }
@@ -114,30 +79,28 @@ Params GotoTaskSolver::solve() {
     Point offset{screen_width/2 - (cols - 1) * step_x / 2, screen_height/2 - (rows - 1) * step_y / 2};
 
     for (int device = 0; device < device_count; ++device) {
-        devices[device].center = Point{(perm[device] % cols) * step_x + offset.x,
-                                       (perm[device] / cols) * step_y + offset.y};
+        layout.set_center(device, Point{(perm[device] % cols) * step_x + offset.x,
+                                       (perm[device] / cols) * step_y + offset.y});
     }
 
     double cpu_time = static_cast<double>(clock() - start) / 1e6;
 
-    write_layout(output_layout_path);
+    write_output();
 
     auto debug_info = solver.get_debug_info();
 
     Params params{
             {CPU_time, my_round(cpu_time, 3) + " sec", false},
-            {TWL_manhattan, my_round(calc_metric(calc_manhattan)), false},
-            {TWL_HP, my_round(calc_metric(calc_half_p)), false},
-            {TWL_clique, my_round(calc_metric(calc_clique)), false},
-            {TWL_hybrid, my_round(calc_metric(calc_hybrid)), false},
     };
+    add_metrics(params);
 
+    WirelengthTracker tracker(layout);
     for (auto [t, perm] : debug_info) {
         for (int device = 0; device < device_count; ++device) {
-            devices[device].center = Point{(perm[device] % cols) * step_x,
-                                           (perm[device] / cols) * step_y};
+            tracker.move(device, Point{(perm[device] % cols) * step_x,
+                                       (perm[device] / cols) * step_y});
         }
-        params.push_back(Param{"di_" + std::to_string(t), std::to_string(calc_metric(calc_manhattan)), false});
+        add_debug_info(params, t, tracker.manhattan());
     }
 
     return params;
@@ -13,6 +13,10 @@
 #include "newGotoSolver.h"
 
 #include <pybind11/stl.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <chrono>
 
@@ -40,6 +44,8 @@ std::string dp_name{"dp_linear"};
 std::string goto_name{"goto"};
 std::string new_goto_name{"new_goto"};
 
+std::string cancel_token_name{"cancel_token"};
+
 std::vector<std::string> solver_names = {
         idle_name,
         bf_name,
@@ -51,6 +57,51 @@ std::vector<std::string> solver_names = {
         new_goto_name
 };
 
+namespace {
+
+    // cancel flags by the token placer.cancel_token gave out, each serves one solve. A solve holds its
+    // own reference, the entry is erased when the solve ends or the token is released
+    std::mutex cancel_mutex;
+    std::map<int, std::shared_ptr<std::atomic<bool>>> cancel_flags;
+    int next_cancel_token{0};
+
+    // the flag of one solve, of its token if it has one, which is spent when the solve ends
+    class SolveCancel {
+    public:
+        explicit SolveCancel(int token) : token(token) {
+            if (token == -1) {
+                flag = std::make_shared<std::atomic<bool>>(false);
+                return;
+            }
+            std::lock_guard<std::mutex> lock(cancel_mutex);
+            auto it = cancel_flags.find(token);
+            if (it == cancel_flags.end()) {
+                throw std::runtime_error("No such cancel token");
+            }
+            flag = it->second;
+        }
+
+        SolveCancel(const SolveCancel&) = delete;
+        SolveCancel& operator=(const SolveCancel&) = delete;
+
+        ~SolveCancel() {
+            if (token != -1) {
+                std::lock_guard<std::mutex> lock(cancel_mutex);
+                cancel_flags.erase(token);
+            }
+        }
+
+        [[nodiscard]] const std::atomic<bool>* get() const {
+            return flag.get();
+        }
+
+    private:
+        int token;
+        std::shared_ptr<std::atomic<bool>> flag;
+    };
+
+} // namespace
+
 py::list solvers() {
     return py::cast(solver_names);
 }
@@ -107,9 +158,17 @@ py::list solve(const py::str& solver_name,
                const py::str& output_path,
                const py::kwargs& kwargs) {
     try {
+        int token = kwargs.contains(cancel_token_name) ? kwargs[cancel_token_name.c_str()].cast<int>() : -1;
+        SolveCancel cancel(token);
         auto solver = create_solver(solver_name);
         solver->init(input_path, output_path, kwargs);
-        Params result = solver->solve();
+        solver->set_cancel(cancel.get());
+        Params result;
+        {
+            // solvers do not touch Python objects, so another thread may run placer.cancel meanwhile
+            py::gil_scoped_release release;
+            result = solver->solve();
+        }
         return py::cast(convert_params(result));
     } catch (std::exception& e) {
         return py::cast(create_from_exception(e));
@@ -117,6 +176,59 @@ py::list solve(const py::str& solver_name,
 
 }
 
+int cancel_token() {
+    std::lock_guard<std::mutex> lock(cancel_mutex);
+    int token = next_cancel_token++;
+    cancel_flags[token] = std::make_shared<std::atomic<bool>>(false);
+    return token;
+}
+
+bool cancel(int token) {
+    std::lock_guard<std::mutex> lock(cancel_mutex);
+    auto it = cancel_flags.find(token);
+    if (it == cancel_flags.end()) {
+        return false;
+    }
+    *it->second = true;
+    return true;
+}
+
+bool release_cancel_token(int token) {
+    std::lock_guard<std::mutex> lock(cancel_mutex);
+    auto it = cancel_flags.find(token);
+    if (it == cancel_flags.end()) {
+        return false;
+    }
+    // a running solve holds a reference too, its token stays cancellable until it ends
+    if (it->second.use_count() == 1) {
+        cancel_flags.erase(it);
+    }
+    return true;
+}
+
+py::list convert_layout(const py::str& input_path,
+                        const py::str& output_path) {
+    try {
+        convert_layout_file(input_path.cast<std::string>(), output_path.cast<std::string>());
+        return py::list{};
+    } catch (std::exception& e) {
+        return py::cast(create_from_exception(e));
+    }
+}
+
+py::list apply_placement(const py::str& layout_path,
+                         const py::str& placement_path,
+                         const py::str& output_path) {
+    try {
+        apply_placement_file(layout_path.cast<std::string>(),
+                             placement_path.cast<std::string>(),
+                             output_path.cast<std::string>());
+        return py::list{};
+    } catch (std::exception& e) {
+        return py::cast(create_from_exception(e));
+    }
+}
+
 py::list gen_cluster_layout(
                     const std::string& path,
                     int seed,
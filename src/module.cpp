@@ -13,6 +13,11 @@ PYBIND11_MODULE(placer, m) {
     m.def("validate_and_estimate", &validate_and_estimate,
           py::arg("solver"), py::arg("input"), py::arg("output"));
     m.def("solve", &solve, py::arg("solver"), py::arg("input"), py::arg("output"));
+    m.def("cancel_token", &cancel_token);
+    m.def("cancel", &cancel, py::arg("token"));
+    m.def("release_cancel_token", &release_cancel_token, py::arg("token"));
+    m.def("convert_layout", &convert_layout, py::arg("input"), py::arg("output"));
+    m.def("apply_placement", &apply_placement, py::arg("layout"), py::arg("placement"), py::arg("output"));
 
     m.def("gen_cluster_layout", &gen_cluster_layout, 
         py::arg("path"),
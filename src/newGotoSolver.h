@@ -9,7 +9,6 @@
 #include "TaskSolver.h"
 
 #include "../algo/new_goto.h"
-#include "../algo/zd_heurist_2.h"
 
 class newGotoTaskSolver : public TaskSolver {
 public:
@@ -23,12 +22,6 @@ public:
 
     void config_defaults();
 
-    std::vector<int> do_local_upd(const std::vector<int>& perm,
-                                  const NewGoto::pin_acc_t& left, const NewGoto::pin_acc_t& same_x,
-                                  const NewGoto::pin_acc_t& up, const NewGoto::pin_acc_t& same_y,
-                                  const NewGoto::mul_t& mul,
-                                  int a = 4, int b = 4) const;
-
 private:
     int rows;
     int cols;
@@ -44,7 +37,6 @@ private:
     int lambda;
     int eps;
     int defaults;
-    int local_upd;
 
     const int DEFAULT_TIME{1};
     const int DEFAULT_SEED{-1};
@@ -57,7 +49,6 @@ private:
     const int DEFAULT_DEFAULTS{1};
     const int DEFAULT_LAMBDA{4};
     const int DEFAULT_EPS{4};
-    const int DEFAULT_LOCAL_UPD{0};
 
     const std::string time_name{"time"};
     const std::string seed_name{"seed"};
@@ -68,7 +59,6 @@ private:
     const std::string lambda_name{"lambda"};
     const std::string eps_name{"eps"};
     const std::string defaults_name{"defaults"};
-    const std::string local_upd_name{"local_upd"};
 };
 
 #endif //PYBIND11_ALGO_NEWGOTOSOLVER_H
@@ -1,5 +1,7 @@
 #include "newTaskSolver.h"
 
+#include "CostCache.h"
+#include "MemoryBudget.h"
 #include "../algo/new_heurist_QAP.h"
 
 #include <random>
@@ -19,14 +21,34 @@ Params newTaskSolver::get_params() {
         {S_name, std::to_string(DEFAULT_S), true},
         {z_name, std::to_string(DEFAULT_Z), true},
         {debug_t_name, std::to_string(DEFAULT_DEBUG_T), true},
-        {defaults_name, std::to_string(DEFAULT_DEFAULTS), true}
+        {defaults_name, std::to_string(DEFAULT_DEFAULTS), true},
+        {placement_only_name, std::to_string(DEFAULT_PLACEMENT_ONLY), true},
+        {metrics_name, DEFAULT_METRICS, true},
+        {implicit_cost_name, std::to_string(DEFAULT_IMPLICIT_COST), true},
+        {tensor_order_name, DEFAULT_TENSOR_ORDER, true},
+        {huge_pages_name, std::to_string(DEFAULT_HUGE_PAGES), true},
+        {threads_name, std::to_string(DEFAULT_THREADS), true},
+        {net_model_name, DEFAULT_NET_MODEL, true},
+        {cost_cache_name, DEFAULT_COST_CACHE, true}
     };
 }
 
 Params newTaskSolver::estimate() {
-    return {
-        {expect_time, std::to_string(time) + " sec", false}
+    Params params{
+        {expect_time, std::to_string(time) + " sec", false},
+        {cost_model, implicit_cost ? "implicit" : "tensor", false}
     };
+    add_peak_memory(params, peak_memory_bytes());
+    return params;
+}
+
+double newTaskSolver::peak_memory_bytes() const {
+    double n = device_count;
+    // tabu matrix and S + 3 solutions of a permutation and priorities
+    double engine = n * n * sizeof(int) + (S + 3.0) * n * (sizeof(int) + sizeof(float));
+    double cost = implicit_cost ? cost_oracle_peak_bytes(layout, net_model)
+                                : cost_tensor_peak_bytes(layout, net_model, rows, cols, threads);
+    return cost + engine;
 }
 
 void newTaskSolver::config_defaults(int rows, int cols, int time) {
@@ -71,80 +93,14 @@ Params newTaskSolver::solve() {
 
     int n = device_count;
 
-    using vl = std::vector<long long>;
-    using vvl = std::vector<vl>;
-    using vvvl = std::vector<vvl>;
-    using vvvvl = std::vector<vvvl>;
-
-    auto cost = vvvvl(n, vvvl(n, vvl(n, vl(n, 0))));
-
-    long long LCM = 1;
-    const int maxLCM = 1e9;
-
-    for (int n_id = 0; n_id < net_count; ++n_id) {
-        int size = nets[n_id].pins.size();
-        if (size <= 1) {
-            continue;
-        }
-        LCM = 1ll * LCM * (size - 1) / gcd(LCM, 1ll * size - 1);
-        if (LCM > maxLCM) {
-            throw std::runtime_error("Too big nets");
-        }
-    }
-
-    for (int n_id = 0; n_id < net_count; ++n_id) {
-        Net* cur_net = nets + n_id;
-        auto cur_pin = cur_net->pins;
-        int size = cur_pin.size();
-        if (size <= 1) {
-            continue;
-        }
-        int w = LCM / (size - 1);
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-
-                if (i == j) {
-                    continue;
-                }
-
-                Pin *a = cur_pin[i];
-                Pin *b = cur_pin[j];
-                if (a->assigned_device->id == b->assigned_device->id) {
-                    continue;
-                }
-
-                int da = a->assigned_device->id;
-                int db = b->assigned_device->id;
-                Point old_cent_da = a->assigned_device->center;
-                Point old_cent_db = b->assigned_device->center;
-
-                for (int p1 = 0; p1 < (int) locations.size(); ++p1) {
-                    a->assigned_device->center = locations[p1];
-                    for (int p2 = 0; p2 < (int) locations.size(); ++p2) {
-                        if (p1 == p2) {
-                            continue;
-                        }
-                        b->assigned_device->center = locations[p2];
-
-                        Point pos_a = a->absolute();
-                        Point pos_b = b->absolute();
-
-                        int dx = pos_a.x - pos_b.x;
-                        int dy = pos_a.y - pos_b.y;
-
-                        int dist = abs(dx) + abs(dy);
-
-                        cost[da][db][p1][p2] += 1ll * w * dist;
-                    }
-                }
-
-                a->assigned_device->center = old_cent_da;
-                b->assigned_device->center = old_cent_db;
-            }
-        }
-    }
+    // the oracle drops the n^4 tensor for large grids, see GridCostOracle
+    QapCost cost = implicit_cost
+                   ? QapCost(cached_cost_oracle(cost_cache, layout, net_model, rows, cols, step_x, step_y))
+                   : QapCost(cached_cost_tensor(cost_cache, layout, net_model, rows, cols, step_x, step_y, threads,
+                                                tensor_order, huge_pages));
 
-    NewHeuristQAP solver(cost);
+    NewHeuristQAP solver(std::move(cost));
+    solver.set_cancel(cancel_flag);
     if (seed == -1) {
         std::mt19937 rnd{(uint32_t) std::chrono::high_resolution_clock().now().time_since_epoch().count()};
         seed = rnd();
@@ -163,10 +119,10 @@ Params newTaskSolver::solve() {
     auto best = solver.solve(n1, n2, tabu_tenure, S, z, time, -1, seed, false, debug_interval);
 
     for (int i = 0; i < n; ++i) {
-        devices[i].center = locations[best[i]];
+        layout.set_center(i, locations[best[i]]);
     }
 
-    write_layout(output_layout_path);
+    write_output();
 
     double cpu_time = static_cast<double>(clock() - start) / 1e6;
 
@@ -174,17 +130,15 @@ Params newTaskSolver::solve() {
 
     Params params{
             {CPU_time, my_round(cpu_time, 3) + " sec", false},
-            {TWL_manhattan, my_round(calc_metric(calc_manhattan)), false},
-            {TWL_HP, my_round(calc_metric(calc_half_p)), false},
-            {TWL_clique, my_round(calc_metric(calc_clique)), false},
-            {TWL_hybrid, my_round(calc_metric(calc_hybrid)), false},
     };
+    add_metrics(params);
 
+    WirelengthTracker tracker(layout);
     for (auto [t, perm] : debug_info) {
         for (int i = 0; i < n; ++i) {
-            devices[i].center = locations[perm[i]];
+            tracker.move(i, locations[perm[i]]);
         }
-        params.push_back(Param{"di_" + std::to_string(t), std::to_string(calc_metric(calc_manhattan)), false});
+        add_debug_info(params, t, tracker.manhattan());
     }
 
     return params;
@@ -194,8 +148,7 @@ void newTaskSolver::init(const py::str& input_path,
         const py::str& output_path,
         const py::kwargs& kwargs) {
 
-    init_layout(input_path.cast<std::string>());
-    output_layout_path = output_path.cast<std::string>();
+    init_common(input_path, output_path, kwargs);
 
     get_value_nodef(kwargs, rows_name, rows);
     get_value_nodef(kwargs, cols_name, cols);
@@ -211,8 +164,21 @@ void newTaskSolver::init(const py::str& input_path,
     get_value(kwargs, S_name, S, DEFAULT_S);
     get_value(kwargs, z_name, z, DEFAULT_Z);
     get_value(kwargs, seed_name, seed, DEFAULT_SEED);
+    get_value(kwargs, implicit_cost_name, implicit_cost, DEFAULT_IMPLICIT_COST);
+    get_value(kwargs, huge_pages_name, huge_pages, DEFAULT_HUGE_PAGES);
+
+    std::string tensor_order_str;
+    get_value_str(kwargs, tensor_order_name, tensor_order_str, DEFAULT_TENSOR_ORDER);
+    tensor_order = parse_tensor_order(tensor_order_str);
 
     get_value_double(kwargs, debug_t_name, debug_t, DEFAULT_DEBUG_T);
 
     get_value(kwargs, defaults_name, defaults, DEFAULT_DEFAULTS);
+
+    // a tensor over the budget gives way to the oracle before anything is built
+    double n = device_count;
+    if (!implicit_cost && (n * n * n * n > CostTensor::MAX_ENTRIES || peak_memory_bytes() > memory_budget)) {
+        implicit_cost = 1;
+    }
+    check_memory(peak_memory_bytes());
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "TaskSolver.h"
+#include "../algo/cost_tensor.h"
 
 class newTaskSolver : public TaskSolver {
 public:
@@ -28,6 +29,9 @@ private:
     int S;
     int z;
     int defaults;
+    int implicit_cost;
+    CostTensor::Order tensor_order{CostTensor::Order::ijkl}; // entry order of the explicit tensor
+    int huge_pages;
 
     const int DEFAULT_TIME{1};
     const int DEFAULT_SEED{-1};
@@ -39,6 +43,9 @@ private:
     const int DEFAULT_S{100};
     const int DEFAULT_Z{10};
     const int DEFAULT_DEFAULTS{1};
+    const int DEFAULT_IMPLICIT_COST{0};
+    const std::string DEFAULT_TENSOR_ORDER{"ijkl"};
+    const int DEFAULT_HUGE_PAGES{0};
 
     const std::string time_name{"time"};
     const std::string seed_name{"seed"};
@@ -48,4 +55,12 @@ private:
     const std::string S_name{"S"};
     const std::string z_name{"z"};
     const std::string defaults_name{"defaults"};
+    const std::string implicit_cost_name{"implicit_cost"};
+    const std::string tensor_order_name{"tensor_order"};
+    const std::string huge_pages_name{"huge_pages"};
+
+    std::string cost_model{"Cost model"};
+
+    // cost model and engine, see MemoryBudget.h
+    [[nodiscard]] double peak_memory_bytes() const;
 };
\ No newline at end of file
@@ -4,8 +4,15 @@
 //
 
 #include "zdTaskSolver.h"
+#include "CostCache.h"
+#include "MemoryBudget.h"
 #include "../algo/ZD_heurist_QAP1.h"
+#include "../algo/deadline.h"
+#include "../algo/multistart.h"
+#include "../algo/parallel.h"
 
+#include <atomic>
+#include <memory>
 #include <cmath>
 #include <algorithm>
 #include <random>
@@ -21,19 +28,45 @@ Params zdTaskSolver::get_params() {
             {time_name, std::to_string(DEFAULT_TIME), true},
             {iters_name, std::to_string(DEFAULT_ITERS), true},
             {k_name, std::to_string(DEFAULT_K), true},
-            {debug_t_name, std::to_string(DEFAULT_DEBUG_T), true}
+            {debug_t_name, std::to_string(DEFAULT_DEBUG_T), true},
+            {placement_only_name, std::to_string(DEFAULT_PLACEMENT_ONLY), true},
+            {metrics_name, DEFAULT_METRICS, true},
+            {implicit_cost_name, std::to_string(DEFAULT_IMPLICIT_COST), true},
+            {tensor_order_name, DEFAULT_TENSOR_ORDER, true},
+            {huge_pages_name, std::to_string(DEFAULT_HUGE_PAGES), true},
+            {scan_threads_name, std::to_string(DEFAULT_SCAN_THREADS), true},
+            {threads_name, std::to_string(DEFAULT_THREADS), true},
+            {net_model_name, DEFAULT_NET_MODEL, true},
+            {cost_cache_name, DEFAULT_COST_CACHE, true}
     };
 }
 
 Params zdTaskSolver::estimate() {
-    return {
-        {expect_time, std::to_string(time) + " sec", false}
+    Params params{
+        {expect_time, std::to_string(time) + " sec", false},
+        {cost_model, implicit_cost ? "implicit" : "tensor", false}
     };
+    add_peak_memory(params, peak_memory_bytes());
+    return params;
+}
+
+double zdTaskSolver::peak_memory_bytes() const {
+    double n = device_count;
+    // list0, list1, list2 and memory hold up to k solutions each,
+    // those in the lists, the center and bfs also an n x n swap delta matrix, see swap_delta.h
+    double engine = (4.0 * k + 8) * (n * sizeof(int) + 32) + (3.0 * k + 3) * n * n * sizeof(long long);
+    if (parallel::resolve_threads(scan_threads) > 1) {
+        // a summary of every row of list0 for the parallel scans
+        engine += k * n * n * (2 * sizeof(long long) + 2 * sizeof(int));
+    }
+    engine *= parallel::resolve_threads(threads); // an engine per worker on the shared cost
+    double cost = implicit_cost ? cost_oracle_peak_bytes(layout, net_model)
+                                : cost_tensor_peak_bytes(layout, net_model, rows, cols, threads);
+    return cost + engine;
 }
 
 void zdTaskSolver::init(const py::str &input_path, const py::str &output_path, const py::kwargs &kwargs) {
-    init_layout(input_path.cast<std::string>());
-    output_layout_path = output_path.cast<std::string>();
+    init_common(input_path, output_path, kwargs);
 
     get_value_nodef(kwargs, rows_name, rows);
     get_value_nodef(kwargs, cols_name, cols);
@@ -49,8 +82,22 @@ void zdTaskSolver::init(const py::str &input_path, const py::str &output_path, c
     get_value(kwargs, time_name, time, DEFAULT_TIME);
     get_value(kwargs, k_name, k, DEFAULT_K);
     get_value(kwargs, seed_name, seed, DEFAULT_SEED);
+    get_value(kwargs, implicit_cost_name, implicit_cost, DEFAULT_IMPLICIT_COST);
+    get_value(kwargs, huge_pages_name, huge_pages, DEFAULT_HUGE_PAGES);
+    get_value(kwargs, scan_threads_name, scan_threads, DEFAULT_SCAN_THREADS);
+
+    std::string tensor_order_str;
+    get_value_str(kwargs, tensor_order_name, tensor_order_str, DEFAULT_TENSOR_ORDER);
+    tensor_order = parse_tensor_order(tensor_order_str);
 
     get_value_double(kwargs, debug_t_name, debug_t, DEFAULT_DEBUG_T);
+
+    // a tensor over the budget gives way to the oracle before anything is built
+    double n = device_count;
+    if (!implicit_cost && (n * n * n * n > CostTensor::MAX_ENTRIES || peak_memory_bytes() > memory_budget)) {
+        implicit_cost = 1;
+    }
+    check_memory(peak_memory_bytes());
 }
 
 Params zdTaskSolver::solve() {
@@ -67,143 +114,109 @@ Params zdTaskSolver::solve() {
 
     int n = device_count;
 
-    using vl = std::vector<long long>;
-    using vvl = std::vector<vl>;
-    using vvvl = std::vector<vvl>;
-    using vvvvl = std::vector<vvvl>;
-
-
-    auto cost = vvvvl(n, vvvl(n, vvl(n, vl(n, 0))));
-
-    long long LCM = 1;
-    const int maxLCM = 1e9;
-
-    for (int n_id = 0; n_id < net_count; ++n_id) {
-        int size = nets[n_id].pins.size();
-        if (size <= 1) {
-            continue;
-        }
-        LCM = 1ll * LCM * (size - 1) / gcd(LCM, 1ll * size - 1);
-        if (LCM > maxLCM) {
-            throw std::runtime_error("Too big nets");
-        }
-    }
-
-    for (int n_id = 0; n_id < net_count; ++n_id) {
-        Net* cur_net = nets + n_id;
-        auto cur_pin = cur_net->pins;
-        int size = cur_pin.size();
-        if (size <= 1) {
-            continue;
-        }
-        int w = LCM / (size - 1);
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-
-                if (i == j) {
-                    continue;
-                }
-
-                Pin* a = cur_pin[i];
-                Pin* b = cur_pin[j];
-                if (a->assigned_device->id == b->assigned_device->id) {
-                    continue;
-                }
-
-                int da = a->assigned_device->id;
-                int db = b->assigned_device->id;
-                Point old_cent_da = a->assigned_device->center;
-                Point old_cent_db = b->assigned_device->center;
-
-                for (int p1 = 0; p1 < (int) locations.size(); ++p1) {
-                    a->assigned_device->center = locations[p1];
-                    for (int p2 = 0; p2 < (int) locations.size(); ++p2) {
-                        if (p1 == p2) {
-                            continue;
-                        }
-                        b->assigned_device->center = locations[p2];
-
-                        Point pos_a = a->absolute();
-                        Point pos_b = b->absolute();
-
-                        int dx = pos_a.x - pos_b.x;
-                        int dy = pos_a.y - pos_b.y;
-
-                        int dist = abs(dx) + abs(dy);
-
-                        cost[da][db][p1][p2] += 1ll * w * dist;
-                    }
-                }
-
-                a->assigned_device->center = old_cent_da;
-                b->assigned_device->center = old_cent_db;
-            }
-        }
-    }
-
-    std::vector<int> best;
-    long long best_twl = 1e18;
+    // the oracle drops the n^4 tensor for large grids, see GridCostOracle
+    QapCost cost = implicit_cost
+                   ? QapCost(cached_cost_oracle(cost_cache, layout, net_model, rows, cols, step_x, step_y))
+                   : QapCost(cached_cost_tensor(cost_cache, layout, net_model, rows, cols, step_x, step_y, threads,
+                                                tensor_order, huge_pages));
 
-    ZD_heurist_2 solver(cost, k);
+    // the engines below read it through shares, which are not checked
+    cost.check_symmetric();
 
-    clock_t max_time = 1e6 * time;
     if (seed == -1) {
         std::mt19937 rnd{(uint32_t) std::chrono::high_resolution_clock().now().time_since_epoch().count()};
         seed = rnd();
     }
-    std::mt19937 rnd{(uint32_t) seed};
     int debug_interval = -1;
     if (debug_t != 0) {
         debug_interval = 1e6 * debug_t;
     }
+
+    // restarts run side by side on every worker until the time is spent, each with its own engine,
+    // so its own solution arena, and its own random stream, see multistart
+    struct Worker {
+        ZD_heurist_QAP1 solver;
+        // the tracker moves the centers it reads, each worker moves its own
+        std::vector<int> center_x, center_y;
+        LayoutView own;
+        WirelengthTracker restarts;
+
+        Worker(const QapCost& cost, int k, const LayoutView& layout)
+                : solver(cost.share(), k),
+                  center_x(layout.center_x, layout.center_x + layout.device_count),
+                  center_y(layout.center_y, layout.center_y + layout.device_count),
+                  own(with_centers(layout, center_x.data(), center_y.data())), restarts(own) {}
+
+        static LayoutView with_centers(LayoutView layout, int* x, int* y) {
+            layout.center_x = x;
+            layout.center_y = y;
+            return layout;
+        }
+    };
+    int workers = parallel::resolve_threads(threads);
+    std::vector<std::unique_ptr<Worker>> state(workers);
+
     auto start = clock();
-    while ((clock() - start) <= max_time) {
-        int rem = max_time - (clock() - start);
-        auto cur = solver.solve(rem, rnd(), debug_interval, ((double)(clock() - start)) / 1e6);
+    // placer.cancel stops the restarts and the one running on each worker. Every restart runs until this
+    // deadline, so the budget left is never measured apart from it; a worker starts none once it expired
+    const Deadline deadline(time, cancel_flag);
+    std::vector<Deadline> until(workers, deadline);
+
+    multistart::Best best = multistart::run(workers, seed, [&](int w, int restart_seed) {
+        if (state[w] == nullptr) {
+            state[w] = std::make_unique<Worker>(cost, k, layout);
+            state[w]->solver.set_scan_threads(scan_threads);
+        }
+        Worker& worker = *state[w];
+        auto cur = worker.solver.solve(deadline, restart_seed, debug_interval);
         for (int j = 0; j < n; ++j) {
-            devices[j].center = locations[cur[j]];
+            worker.restarts.move(j, locations[cur[j]]);
         }
-        double cur_twl = calc_metric(calc_manhattan);
-        if (cur_twl < best_twl) {
-            best_twl = cur_twl;
-            best = cur;
+        return std::make_pair(std::move(cur), worker.restarts.manhattan());
+    }, [&](int w, int) {
+        return !until[w].expired();
+    });
+
+    std::vector<std::pair<double, std::vector<int>>> debug_info;
+    for (auto& worker : state) {
+        if (worker != nullptr) {
+            auto info = worker->solver.get_debug_info();
+            debug_info.insert(debug_info.end(), info.begin(), info.end());
         }
     }
+    std::stable_sort(debug_info.begin(), debug_info.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
 
-    if (best.empty()) {
+    if (best.p.empty()) {
         throw std::runtime_error("Not solved");
     }
 
     for (int i = 0; i < n; ++i) {
-        devices[i].center = locations[best[i]];
+        layout.set_center(i, locations[best.p[i]]);
     }
 
-    write_layout(output_layout_path);
+    write_output();
 
     double cpu_time = static_cast<double>(clock() - start) / 1e6;
 
     Params params{
             {CPU_time, my_round(cpu_time, 3) + " sec", false},
-            {TWL_manhattan, my_round(calc_metric(calc_manhattan)), false},
-            {TWL_HP, my_round(calc_metric(calc_half_p)), false},
-            {TWL_clique, my_round(calc_metric(calc_clique)), false},
-            {TWL_hybrid, my_round(calc_metric(calc_hybrid)), false},
     };
-
-    auto debug_info = solver.get_debug_info();
+    add_metrics(params);
 
     double last_twl;
     bool first{true};
 
+    WirelengthTracker tracker(layout);
     for (auto [t, perm] : debug_info) {
         for (int i = 0; i < n; ++i) {
-            devices[i].center = locations[perm[i]];
+            tracker.move(i, locations[perm[i]]);
         }
         if (first) {
-            last_twl = calc_metric(calc_manhattan);
+            last_twl = tracker.manhattan();
             first = false;
         } else {
-            double cur_twl = calc_metric(calc_manhattan);
+            double cur_twl = tracker.manhattan();
             if (cur_twl < last_twl) {
                 last_twl = cur_twl;
             }
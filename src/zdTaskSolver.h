@@ -7,6 +7,7 @@
 #define PYBIND11_ALGO_ZDTASKSOLVER_H
 
 #include "TaskSolver.h"
+#include "../algo/cost_tensor.h"
 
 class zdTaskSolver : public TaskSolver {
 public:
@@ -28,6 +29,10 @@ private:
     int k;
     int time;
     int seed;
+    int implicit_cost;
+    CostTensor::Order tensor_order{CostTensor::Order::ijkl}; // entry order of the explicit tensor
+    int huge_pages;
+    int scan_threads;
 
     const int DEFAULT_ITERS{2000};
     const int DEFAULT_K{2};
@@ -35,11 +40,24 @@ private:
     const int DEFAULT_SEED{-1};
     const int DEFAULT_STEP_X{70};
     const int DEFAULT_STEP_Y{70};
+    const int DEFAULT_IMPLICIT_COST{0};
+    const std::string DEFAULT_TENSOR_ORDER{"ijkl"};
+    const int DEFAULT_HUGE_PAGES{0};
+    const int DEFAULT_SCAN_THREADS{1};
 
     const std::string iters_name{"iters"};
     const std::string k_name{"k"};
     const std::string time_name{"time"};
     const std::string seed_name{"seed"};
+    const std::string implicit_cost_name{"implicit_cost"};
+    const std::string tensor_order_name{"tensor_order"};
+    const std::string huge_pages_name{"huge_pages"};
+    const std::string scan_threads_name{"scan_threads"};
+
+    std::string cost_model{"Cost model"};
+
+    // cost model and engine, see MemoryBudget.h
+    [[nodiscard]] double peak_memory_bytes() const;
 };
 
 